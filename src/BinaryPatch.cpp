@@ -0,0 +1,116 @@
+#include "BinaryPatch.hpp"
+#include "include/wx.hpp"
+#include <wx/wfstream.h>
+#include <wx/zstream.h>
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+#define PATCH_MAGIC "GEODE/BSDIFF43Z1"
+#define PATCH_MAGIC_SIZE 16
+// refuse to allocate absurd sizes 
+// from a corrupt header
+#define PATCH_MAX_SIZE (512ll * 1024 * 1024)
+
+// bsdiff stores integers as sign & magnitude, 
+// little endian
+static int64_t readPatchInt(const uint8_t* buf) {
+    int64_t y = buf[7] & 0x7F;
+    for (int i = 6; i >= 0; i--) {
+        y = y * 256 + buf[i];
+    }
+    return (buf[7] & 0x80) ? -y : y;
+}
+
+static bool readExact(wxInputStream& stream, void* data, size_t size) {
+    return size == 0 || stream.ReadAll(data, size);
+}
+
+Result<> applyBinaryPatch(
+    ghc::filesystem::path const& oldFile,
+    ghc::filesystem::path const& patchFile,
+    ghc::filesystem::path const& newFile
+) {
+    std::ifstream ifs(oldFile, std::ios::binary);
+    if (!ifs.is_open()) {
+        return Err("Unable to read " + oldFile.string());
+    }
+    std::vector<uint8_t> old(
+        (std::istreambuf_iterator<char>(ifs)),
+        std::istreambuf_iterator<char>()
+    );
+    auto oldSize = static_cast<int64_t>(old.size());
+
+    wxFileInputStream fis(patchFile.wstring());
+    if (!fis.IsOk()) {
+        return Err("Unable to read " + patchFile.string());
+    }
+    uint8_t header[PATCH_MAGIC_SIZE + 8];
+    if (
+        !readExact(fis, header, sizeof(header)) ||
+        std::memcmp(header, PATCH_MAGIC, PATCH_MAGIC_SIZE) != 0
+    ) {
+        return Err("Not a valid patch file");
+    }
+    auto newSize = readPatchInt(header + PATCH_MAGIC_SIZE);
+    if (newSize < 0 || newSize > PATCH_MAX_SIZE) {
+        return Err("Patch has an invalid size");
+    }
+
+    wxZlibInputStream zis(fis, wxZLIB_ZLIB);
+    std::vector<uint8_t> result(static_cast<size_t>(newSize));
+    int64_t oldPos = 0;
+    int64_t newPos = 0;
+    while (newPos < newSize) {
+        uint8_t ctrl[24];
+        if (!readExact(zis, ctrl, sizeof(ctrl))) {
+            return Err("Patch is truncated");
+        }
+        auto diffSize = readPatchInt(ctrl);
+        auto extraSize = readPatchInt(ctrl + 8);
+        auto seek = readPatchInt(ctrl + 16);
+        // newPos never passes newSize, so 
+        // none of these can overflow
+        if (
+            diffSize < 0 || extraSize < 0 ||
+            diffSize > newSize - newPos ||
+            extraSize > newSize - newPos - diffSize
+        ) {
+            return Err("Patch is corrupt");
+        }
+
+        if (!readExact(zis, result.data() + newPos, static_cast<size_t>(diffSize))) {
+            return Err("Patch is truncated");
+        }
+        for (int64_t i = 0; i < diffSize; i++) {
+            if (oldPos + i >= 0 && oldPos + i < oldSize) {
+                result[newPos + i] += old[oldPos + i];
+            }
+        }
+        newPos += diffSize;
+        oldPos += diffSize;
+
+        if (!readExact(zis, result.data() + newPos, static_cast<size_t>(extraSize))) {
+            return Err("Patch is truncated");
+        }
+        newPos += extraSize;
+        // the old position may go past either end 
+        // of the old file, but not further than 
+        // the rest of the new file could reach
+        if (seek < -newSize - oldPos || seek > oldSize + newSize - oldPos) {
+            return Err("Patch is corrupt");
+        }
+        oldPos += seek;
+    }
+
+    std::ofstream ofs(newFile, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) {
+        return Err("Unable to write " + newFile.string());
+    }
+    ofs.write(reinterpret_cast<const char*>(result.data()), result.size());
+    if (!ofs) {
+        return Err("Unable to write " + newFile.string());
+    }
+    return Ok();
+}
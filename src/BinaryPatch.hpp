@@ -0,0 +1,24 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+
+/**
+ * Apply a binary patch to a file, writing the 
+ * patched version to another file.
+ * 
+ * Patches use the bsdiff 4.3 layout (as produced 
+ * by endsley/bsdiff) with zlib in place of bzip2: 
+ * a 16 byte magic, the size of the new file as 
+ * an 8 byte bsdiff integer, then one zlib stream 
+ * of control blocks. Each block is three bsdiff 
+ * integers (diff length, extra length, old file 
+ * seek) followed by that many diff bytes, which 
+ * are added to the old file's bytes, and that 
+ * many extra bytes, which are copied as-is
+ */
+Result<> applyBinaryPatch(
+    ghc::filesystem::path const& oldFile,
+    ghc::filesystem::path const& patchFile,
+    ghc::filesystem::path const& newFile
+);
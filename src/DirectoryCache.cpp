@@ -0,0 +1,51 @@
+#include "DirectoryCache.hpp"
+
+DirectoryCache::DirectoryCache(ExtractTarget& target, ghc::filesystem::path const& root)
+  : m_target(target), m_root(root) {}
+
+Result<ghc::filesystem::path> DirectoryCache::getDirectory(std::string const& name) {
+    auto dir = name;
+    while (dir.size() && dir.back() == '/') {
+        dir.pop_back();
+    }
+    auto found = m_directories.find(dir);
+    if (found != m_directories.end()) {
+        return Ok(found->second);
+    }
+
+    ghc::filesystem::path path;
+    auto slash = dir.rfind('/');
+    if (dir.empty()) {
+        path = m_root;
+        auto res = m_target.createDirectory(path, true);
+        if (!res) return Err(res.error());
+    } else {
+        auto parent = this->getDirectory(
+            slash == std::string::npos ? "" : dir.substr(0, slash)
+        );
+        if (!parent) return parent;
+        path = parent.value() / ghc::filesystem::path(
+            slash == std::string::npos ? dir : dir.substr(slash + 1)
+        );
+        auto res = m_target.createDirectory(path);
+        if (!res) return Err(res.error());
+    }
+    m_created++;
+    m_directories.insert({ dir, path });
+    return Ok(path);
+}
+
+Result<ghc::filesystem::path> DirectoryCache::getFile(std::string const& name) {
+    auto slash = name.rfind('/');
+    auto dir = this->getDirectory(
+        slash == std::string::npos ? "" : name.substr(0, slash)
+    );
+    if (!dir) return dir;
+    return Ok(dir.value() / ghc::filesystem::path(
+        slash == std::string::npos ? name : name.substr(slash + 1)
+    ));
+}
+
+size_t DirectoryCache::getCreatedCount() const {
+    return m_created;
+}
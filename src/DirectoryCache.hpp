@@ -0,0 +1,44 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include "ExtractTarget.hpp"
+#include <string>
+#include <unordered_map>
+
+/**
+ * Directories of an archive being extracted. 
+ * Each one is created (and its full path 
+ * built) the first time an entry needs it, 
+ * after which looking it up is just a hash 
+ * of the archive name. Not thread-safe; paths 
+ * are meant to be worked out before files 
+ * are handed to worker threads
+ */
+class DirectoryCache {
+protected:
+    ExtractTarget& m_target;
+    ghc::filesystem::path m_root;
+    std::unordered_map<std::string, ghc::filesystem::path> m_directories;
+    size_t m_created = 0;
+
+public:
+    DirectoryCache(ExtractTarget& target, ghc::filesystem::path const& root);
+
+    /**
+     * Full path of a directory given by its name 
+     * in the archive ("a/b", "/"-separated), 
+     * creating it and its parents if needed
+     */
+    Result<ghc::filesystem::path> getDirectory(std::string const& name);
+    /**
+     * Full path of a file given by its name in 
+     * the archive. Its directory is created 
+     */
+    Result<ghc::filesystem::path> getFile(std::string const& name);
+    /**
+     * How many directories were looked up 
+     * in the target
+     */
+    size_t getCreatedCount() const;
+};
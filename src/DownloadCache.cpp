@@ -0,0 +1,259 @@
+#include "DownloadCache.hpp"
+#include "include/SHA256.hpp"
+#include "include/json.hpp"
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+
+#define CACHE_INDEX_JSON "index.json"
+
+static long long now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+DownloadCache::DownloadCache(
+    ghc::filesystem::path const& directory,
+    size_t maxSize
+) : m_directory(directory), m_maxSize(maxSize) {}
+
+ghc::filesystem::path DownloadCache::getIndexPath() const {
+    return m_directory / CACHE_INDEX_JSON;
+}
+
+ghc::filesystem::path DownloadCache::getBlobPath(std::string const& hash) const {
+    return m_directory / hash;
+}
+
+Result<> DownloadCache::load() {
+    m_entries.clear();
+    if (!ghc::filesystem::exists(this->getIndexPath())) {
+        return Ok();
+    }
+    try {
+        std::ifstream ifs(this->getIndexPath());
+        auto json = nlohmann::json::parse(ifs);
+        for (auto& item : json["entries"]) {
+            DownloadCacheEntry entry;
+            entry.m_url = item["url"].get<std::string>();
+            entry.m_etag = item["etag"].get<std::string>();
+            entry.m_lastModified = item["last-modified"].get<std::string>();
+            entry.m_hash = item["hash"].get<std::string>();
+            entry.m_size = item["size"].get<size_t>();
+            entry.m_lastUsed = item["last-used"].get<long long>();
+            entry.m_immutable = item["immutable"].get<bool>();
+            // the file may have been deleted by hand
+            if (ghc::filesystem::exists(this->getBlobPath(entry.m_hash))) {
+                m_entries.insert({ entry.m_url, entry });
+            }
+        }
+        m_hits = json.value("hits", 0);
+        m_misses = json.value("misses", 0);
+    } catch(std::exception& e) {
+        m_entries.clear();
+        return Err("Unable to parse download cache index: " + std::string(e.what()));
+    }
+    return Ok();
+}
+
+Result<> DownloadCache::save() {
+    if (
+        !ghc::filesystem::exists(m_directory) &&
+        !ghc::filesystem::create_directories(m_directory)
+    ) {
+        return Err("Unable to create directory " + m_directory.string());
+    }
+    auto json = nlohmann::json::object();
+    json["entries"] = nlohmann::json::array();
+    for (auto& [_, entry] : m_entries) {
+        json["entries"].push_back({
+            { "url", entry.m_url },
+            { "etag", entry.m_etag },
+            { "last-modified", entry.m_lastModified },
+            { "hash", entry.m_hash },
+            { "size", entry.m_size },
+            { "last-used", entry.m_lastUsed },
+            { "immutable", entry.m_immutable },
+        });
+    }
+    json["hits"] = m_hits;
+    json["misses"] = m_misses;
+
+    std::ofstream ofs(this->getIndexPath());
+    if (!ofs.is_open()) {
+        return Err("Unable to write download cache index");
+    }
+    ofs << json.dump(4);
+    return Ok();
+}
+
+DownloadCacheEntry const* DownloadCache::find(std::string const& url) const {
+    auto it = m_entries.find(url);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+tl::optional<ghc::filesystem::path> DownloadCache::get(std::string const& url) {
+    auto it = m_entries.find(url);
+    if (it == m_entries.end() || !it->second.m_immutable) {
+        return tl::nullopt;
+    }
+    return this->revalidated(url);
+}
+
+tl::optional<ghc::filesystem::path> DownloadCache::revalidated(std::string const& url) {
+    auto it = m_entries.find(url);
+    if (it == m_entries.end()) {
+        return tl::nullopt;
+    }
+    auto path = this->getBlobPath(it->second.m_hash);
+    if (!ghc::filesystem::exists(path)) {
+        m_entries.erase(it);
+        this->save();
+        return tl::nullopt;
+    }
+    m_hits++;
+    it->second.m_lastUsed = now();
+    this->save();
+    return path;
+}
+
+bool DownloadCache::isBlobShared(
+    std::string const& hash,
+    std::string const& exceptURL
+) const {
+    for (auto& [url, entry] : m_entries) {
+        if (url != exceptURL && entry.m_hash == hash) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void DownloadCache::removeEntry(std::string const& url) {
+    auto it = m_entries.find(url);
+    if (it == m_entries.end()) return;
+    if (!this->isBlobShared(it->second.m_hash, url)) {
+        std::error_code ec;
+        ghc::filesystem::remove(this->getBlobPath(it->second.m_hash), ec);
+    }
+    m_entries.erase(it);
+}
+
+void DownloadCache::evict() {
+    while (m_entries.size() > 1 && this->getSize() > m_maxSize) {
+        auto oldest = std::min_element(
+            m_entries.begin(), m_entries.end(),
+            [](auto const& a, auto const& b) -> bool {
+                return a.second.m_lastUsed < b.second.m_lastUsed;
+            }
+        );
+        this->removeEntry(oldest->first);
+    }
+}
+
+Result<ghc::filesystem::path> DownloadCache::store(
+    std::string const& url,
+    std::string const& etag,
+    std::string const& lastModified,
+    ghc::filesystem::path const& file,
+    std::string const& hash
+) {
+    if (
+        !ghc::filesystem::exists(m_directory) &&
+        !ghc::filesystem::create_directories(m_directory)
+    ) {
+        return Err("Unable to create directory " + m_directory.string());
+    }
+
+    DownloadCacheEntry entry;
+    entry.m_url = url;
+    entry.m_etag = etag;
+    entry.m_lastModified = lastModified;
+    entry.m_hash = hash.size() ? hash : SHA256::hashFile(file);
+    entry.m_lastUsed = now();
+    entry.m_immutable = DownloadCache::isImmutableURL(url);
+    if (entry.m_hash.empty()) {
+        return Err("Unable to read " + file.string());
+    }
+
+    auto blob = this->getBlobPath(entry.m_hash);
+    try {
+        if (ghc::filesystem::exists(blob)) {
+            // already have this exact file under another URL
+            ghc::filesystem::remove(file);
+        } else {
+            ghc::filesystem::rename(file, blob);
+        }
+        entry.m_size = static_cast<size_t>(ghc::filesystem::file_size(blob));
+    } catch(std::exception& e) {
+        return Err("Unable to move file into the download cache: " + std::string(e.what()));
+    }
+
+    // the server sent the same file again (200 
+    // instead of 304), so the old entry's blob 
+    // is the one just kept
+    auto old = m_entries.find(url);
+    if (old != m_entries.end() && old->second.m_hash == entry.m_hash) {
+        m_entries.erase(old);
+    } else {
+        this->removeEntry(url);
+    }
+    m_entries.insert({ url, entry });
+    m_misses++;
+    this->evict();
+    this->save();
+
+    return Ok(blob);
+}
+
+void DownloadCache::setMaxSize(size_t size) {
+    m_maxSize = size;
+    this->evict();
+}
+
+size_t DownloadCache::getMaxSize() const {
+    return m_maxSize;
+}
+
+size_t DownloadCache::getSize() const {
+    // count every stored file once, even 
+    // if several URLs point to it
+    std::unordered_map<std::string, size_t> blobs;
+    for (auto& [_, entry] : m_entries) {
+        blobs[entry.m_hash] = entry.m_size;
+    }
+    size_t size = 0;
+    for (auto& [_, blobSize] : blobs) {
+        size += blobSize;
+    }
+    return size;
+}
+
+size_t DownloadCache::getHits() const {
+    return m_hits;
+}
+
+size_t DownloadCache::getMisses() const {
+    return m_misses;
+}
+
+Result<> DownloadCache::clear() {
+    m_entries.clear();
+    try {
+        if (ghc::filesystem::exists(m_directory)) {
+            ghc::filesystem::remove_all(m_directory);
+        }
+    } catch(std::exception& e) {
+        return Err("Unable to clear download cache: " + std::string(e.what()));
+    }
+    return Ok();
+}
+
+bool DownloadCache::isImmutableURL(std::string const& url) {
+    // GitHub release assets are tied to a tag
+    return url.find("/releases/download/") != std::string::npos;
+}
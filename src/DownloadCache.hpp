@@ -0,0 +1,104 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "legacy/optional.hpp"
+#include "include/Result.hpp"
+#include <string>
+#include <unordered_map>
+
+struct DownloadCacheEntry {
+    std::string m_url;
+    std::string m_etag;
+    std::string m_lastModified;
+    /**
+     * SHA-256 of the contents; also the name 
+     * of the file in the cache directory
+     */
+    std::string m_hash;
+    size_t m_size = 0;
+    long long m_lastUsed = 0;
+    /**
+     * The URL always points to the same file 
+     * (such as a release asset of a specific 
+     * version), so the entry never has to be 
+     * revalidated with the server
+     */
+    bool m_immutable = false;
+};
+
+/**
+ * Persistent cache of downloaded files in the
+ * data directory. Entries are looked up by URL
+ * and stored by content hash, so different URLs
+ * serving the same file share one copy. The
+ * least recently used entries are evicted when
+ * the cache grows past its size limit
+ */
+class DownloadCache {
+protected:
+    ghc::filesystem::path m_directory;
+    size_t m_maxSize;
+    std::unordered_map<std::string, DownloadCacheEntry> m_entries;
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+
+    ghc::filesystem::path getIndexPath() const;
+    ghc::filesystem::path getBlobPath(std::string const& hash) const;
+    bool isBlobShared(std::string const& hash, std::string const& exceptURL) const;
+    void removeEntry(std::string const& url);
+    void evict();
+
+public:
+    DownloadCache(ghc::filesystem::path const& directory, size_t maxSize);
+
+    Result<> load();
+    Result<> save();
+
+    /**
+     * Find the cache entry of a URL without 
+     * counting it as a hit or a miss. Used for 
+     * conditional requests
+     */
+    DownloadCacheEntry const* find(std::string const& url) const;
+
+    /**
+     * Get the cached file for a URL that can be 
+     * used without asking the server, i.e. an 
+     * immutable one. Counts as a hit if found
+     */
+    tl::optional<ghc::filesystem::path> get(std::string const& url);
+
+    /**
+     * The server confirmed that the cached file 
+     * is still current (304 Not Modified)
+     */
+    tl::optional<ghc::filesystem::path> revalidated(std::string const& url);
+
+    /**
+     * Move a downloaded file into the cache. 
+     * Counts as a miss, since the file had to 
+     * be downloaded. The file is hashed unless 
+     * its SHA-256 is passed in
+     * @returns The path of the cached file
+     */
+    Result<ghc::filesystem::path> store(
+        std::string const& url,
+        std::string const& etag,
+        std::string const& lastModified,
+        ghc::filesystem::path const& file,
+        std::string const& hash = ""
+    );
+
+    void setMaxSize(size_t size);
+    size_t getMaxSize() const;
+    size_t getSize() const;
+    size_t getHits() const;
+    size_t getMisses() const;
+
+    Result<> clear();
+
+    /**
+     * Whether the file behind a URL never changes
+     */
+    static bool isImmutableURL(std::string const& url);
+};
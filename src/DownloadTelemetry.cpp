@@ -0,0 +1,124 @@
+#include "DownloadTelemetry.hpp"
+#include <chrono>
+#include <cstdio>
+
+// rate samples shorter than this are 
+// mostly noise from event batching
+#define TELEMETRY_SAMPLE_MS 250
+#define TELEMETRY_SMOOTHING 0.3
+
+long long DownloadTelemetry::now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+std::string DownloadTelemetry::formatSize(double bytes) {
+    const char* units[] = { "B", "KB", "MB", "GB" };
+    size_t unit = 0;
+    while (bytes >= 1024.0 && unit < 3) {
+        bytes /= 1024.0;
+        unit++;
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof buf, unit ? "%.1f %s" : "%.0f %s", bytes, units[unit]);
+    return buf;
+}
+
+void DownloadTelemetry::start(std::string const& url) {
+    *this = DownloadTelemetry();
+    m_url = url;
+    m_started = now();
+    m_sampleTime = m_started;
+    m_lastData = m_started;
+}
+
+void DownloadTelemetry::dispatched() {
+    auto time = now();
+    m_queueTime = time - m_started;
+    m_started = time;
+    m_sampleTime = time;
+    m_lastData = time;
+}
+
+void DownloadTelemetry::received(long long bytesReceived, long long bytesExpected) {
+    auto time = now();
+    if (m_firstByte < 0 && bytesReceived > 0) {
+        m_firstByte = time - m_started;
+        // don't count the wait for the 
+        // first byte as slow transfer
+        m_sampleTime = time;
+        m_sampleBytes = bytesReceived;
+    }
+    if (bytesReceived > m_bytesReceived) {
+        m_lastData = time;
+    }
+    m_bytesReceived = bytesReceived;
+    m_bytesExpected = bytesExpected;
+
+    auto elapsed = time - m_sampleTime;
+    if (elapsed < TELEMETRY_SAMPLE_MS) return;
+
+    m_rate = (bytesReceived - m_sampleBytes) * 1000.0 / elapsed;
+    m_averageRate = m_averageRate > 0.0 ?
+        TELEMETRY_SMOOTHING * m_rate + (1.0 - TELEMETRY_SMOOTHING) * m_averageRate :
+        m_rate;
+    m_sampleTime = time;
+    m_sampleBytes = bytesReceived;
+}
+
+void DownloadTelemetry::stalled() {
+    m_stalled = true;
+}
+
+void DownloadTelemetry::finish(int status, bool failed, bool cancelled) {
+    m_finished = now() - m_started;
+    m_status = status;
+    m_failed = failed;
+    m_cancelled = cancelled;
+    if (m_firstByte < 0 && !failed) {
+        // the body arrived in one go without 
+        // any data events in between
+        m_firstByte = m_finished;
+    }
+}
+
+bool DownloadTelemetry::isDone() const {
+    return m_finished >= 0;
+}
+
+long long DownloadTelemetry::getTimeToFirstByte() const {
+    return m_firstByte;
+}
+
+long long DownloadTelemetry::getDuration() const {
+    return this->isDone() ? m_finished : now() - m_started;
+}
+
+long long DownloadTelemetry::getIdleTime() const {
+    return now() - m_lastData;
+}
+
+long long DownloadTelemetry::getETA() const {
+    if (m_bytesExpected <= 0 || m_averageRate <= 0.0) {
+        return -1;
+    }
+    auto left = m_bytesExpected - m_bytesReceived;
+    if (left <= 0) return 0;
+    return static_cast<long long>(left / m_averageRate + 0.5);
+}
+
+std::string DownloadTelemetry::describe() const {
+    auto text = formatSize(static_cast<double>(m_bytesReceived));
+    if (m_bytesExpected > 0) {
+        text += " of " + formatSize(static_cast<double>(m_bytesExpected));
+    }
+    if (m_averageRate > 0.0) {
+        text += ", " + formatSize(m_averageRate) + "/s";
+    }
+    auto eta = this->getETA();
+    if (eta >= 0) {
+        text += ", " + std::to_string(eta) + "s left";
+    }
+    return text;
+}
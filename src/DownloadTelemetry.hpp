@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+
+/**
+ * Timings & transfer rate of a download. 
+ * Times are in milliseconds relative to when 
+ * the download was started. wxWebRequest 
+ * doesn't expose DNS or connect timings, so 
+ * the time to first byte covers all of them
+ */
+struct DownloadTelemetry {
+    std::string m_url;
+    int m_status = 0;
+    bool m_failed = false;
+    /**
+     * The request was cancelled rather than 
+     * failing on its own
+     */
+    bool m_cancelled = false;
+    /**
+     * No data arrived for too long; a cancel 
+     * that follows is the server's fault
+     */
+    bool m_stalled = false;
+    /**
+     * Steady clock time the download started at
+     */
+    long long m_started = 0;
+    /**
+     * How long the request waited for a free 
+     * slot before it was sent
+     */
+    long long m_queueTime = 0;
+    long long m_firstByte = -1;
+    long long m_finished = -1;
+    long long m_bytesReceived = 0;
+    /**
+     * -1 if the server didn't send a size
+     */
+    long long m_bytesExpected = -1;
+    /**
+     * Bytes per second over the last sample 
+     * window, and a moving average of it
+     */
+    double m_rate = 0.0;
+    double m_averageRate = 0.0;
+
+    long long m_sampleTime = 0;
+    long long m_sampleBytes = 0;
+    /**
+     * Steady clock time data was last received at
+     */
+    long long m_lastData = 0;
+
+    void start(std::string const& url);
+    /**
+     * The request was actually sent; timings 
+     * are measured from here on
+     */
+    void dispatched();
+    void received(long long bytesReceived, long long bytesExpected);
+    void stalled();
+    void finish(int status, bool failed, bool cancelled = false);
+
+    bool isDone() const;
+    long long getTimeToFirstByte() const;
+    long long getDuration() const;
+    /**
+     * Milliseconds since data was last received, 
+     * or since the start if none has been yet
+     */
+    long long getIdleTime() const;
+    /**
+     * Estimated seconds left, or -1 if the 
+     * size or rate isn't known yet
+     */
+    long long getETA() const;
+    /**
+     * Human readable summary, like 
+     * "1.2 MB of 4.5 MB, 800 KB/s, 4s left"
+     */
+    std::string describe() const;
+
+    static long long now();
+    static std::string formatSize(double bytes);
+};
@@ -0,0 +1,549 @@
+#include "Extract.hpp"
+#include "DirectoryCache.hpp"
+#include "ExtractIndex.hpp"
+#include "MappedZip.hpp"
+#include "PipeStream.hpp"
+#include "ZstdStream.hpp"
+#include "include/CRC32.hpp"
+#include <wx/zipstrm.h>
+#include <wx/tarstrm.h>
+#include <wx/zstream.h>
+#include <wx/mstream.h>
+#include <wx/wfstream.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+// most threads used to extract an archive
+#define UNZIP_MAX_THREADS 8
+// archives with fewer files than this aren't 
+// worth the extra threads
+#define UNZIP_MIN_PARALLEL_FILES 4
+
+static size_t getThreadCount(size_t files, ExtractOptions const& options) {
+    if (options.m_threads) {
+        return std::max<size_t>(std::min(options.m_threads, files), 1);
+    }
+    return files < UNZIP_MIN_PARALLEL_FILES ? 1 : std::min<size_t>(
+        std::max(std::thread::hardware_concurrency(), 1u),
+        std::min<size_t>(UNZIP_MAX_THREADS, files)
+    );
+}
+
+/**
+ * Put an unchanged file into a new tree by 
+ * linking it, or copying where links aren't 
+ * supported. The old tree becomes the backup, 
+ * so anything that updates an installed file 
+ * later has to replace it rather than write 
+ * through the link
+ */
+static bool reuseFile(
+    ghc::filesystem::path const& source,
+    ghc::filesystem::path const& target,
+    ExtractIndex* index,
+    uint32_t crc,
+    size_t size
+) {
+    std::error_code ec;
+    ghc::filesystem::remove(target, ec);
+    ghc::filesystem::create_hard_link(source, target, ec);
+    if (ec) {
+        ec.clear();
+        ghc::filesystem::copy_file(source, target, ec);
+        if (ec) return false;
+    }
+    index->record(target, crc, size);
+    return true;
+}
+
+/**
+ * Write one entry of a mapped zip. Stored data 
+ * is written straight from the mapping and 
+ * deflated data is inflated from it
+ */
+static Result<> extractMapped(
+    ExtractTarget& target,
+    MappedZip const& zip,
+    MappedZipEntry const& entry,
+    ghc::filesystem::path const& path
+) {
+    auto data = zip.getData(entry);
+    if (!data) return Err(data.error());
+
+    auto file = target.openFile(path, entry.m_size);
+    if (!file) return Err(file.error());
+    auto out = file.value();
+    CRC32 crc;
+    if (entry.m_method == wxZIP_METHOD_STORE) {
+        if (entry.m_compressedSize != entry.m_size) {
+            return Err("Zip entry \"" + entry.m_name + "\" is corrupted");
+        }
+        crc.update(data.value(), entry.m_size);
+        auto written = out->write(data.value(), entry.m_size);
+        if (!written) return written;
+    } else {
+        wxMemoryInputStream mem(data.value(), entry.m_compressedSize);
+        wxZlibInputStream zlib(mem, wxZLIB_NO_HEADER);
+        char buffer[0x10000];
+        while (zlib.Read(buffer, sizeof(buffer)).LastRead()) {
+            crc.update(buffer, zlib.LastRead());
+            auto written = out->write(buffer, zlib.LastRead());
+            if (!written) return written;
+        }
+    }
+    auto written = out->getWritten();
+    auto closed = out->close();
+    if (!closed) return closed;
+    if (written != entry.m_size || crc.finish() != entry.m_crc) {
+        return Err("Zip entry \"" + entry.m_name + "\" is corrupted");
+    }
+    return Ok();
+}
+
+/**
+ * Write the rest of a stream to a file of 
+ * the expected size (0 if unknown). The CRC 
+ * & size of what was written are computed 
+ * on the way
+ */
+static Result<> extractEntry(
+    ExtractTarget& target,
+    wxInputStream& in,
+    ghc::filesystem::path const& path,
+    size_t size,
+    uint32_t& crc,
+    size_t& written
+) {
+    auto file = target.openFile(path, size);
+    if (!file) return Err(file.error());
+    auto out = file.value();
+    CRC32 hash;
+    char buffer[0x10000];
+    while (in.Read(buffer, sizeof(buffer)).LastRead()) {
+        hash.update(buffer, in.LastRead());
+        auto wrote = out->write(buffer, in.LastRead());
+        if (!wrote) return wrote;
+    }
+    if (in.GetLastError() == wxSTREAM_READ_ERROR) {
+        return Err("Unable to read \"" + path.string() + "\" from the archive");
+    }
+    crc = hash.finish();
+    written = out->getWritten();
+    return out->close();
+}
+
+/**
+ * Extract a zip that could be memory-mapped. 
+ * Every thread shares the mapping
+ */
+static Result<> unzipMapped(
+    MappedZip const& zip,
+    ExtractTarget& target,
+    ghc::filesystem::path const& targetLocation,
+    ExtractIndex* index,
+    ghc::filesystem::path const& current,
+    ExtractOptions const& options
+) {
+    // same as with wx streams, except that 
+    // every thread can share the mapping
+    std::vector<std::pair<MappedZipEntry const*, ghc::filesystem::path>> pending;
+    DirectoryCache dirs(target, targetLocation);
+    for (auto& entry : zip.getEntries()) {
+        if (entry.isDir()) {
+            auto dir = dirs.getDirectory(entry.m_name);
+            if (!dir) return Err(dir.error());
+            continue;
+        }
+        auto file = dirs.getFile(entry.m_name);
+        if (!file) return Err(file.error());
+        auto path = file.value();
+        if (index) {
+            auto source = current.empty() ?
+                path : current / ghc::filesystem::path(entry.m_name);
+            if (
+                index->isUnchanged(source, entry.m_crc, entry.m_size) &&
+                (source == path || reuseFile(source, path, index, entry.m_crc, entry.m_size))
+            ) {
+                continue;
+            }
+        }
+        pending.push_back({ &entry, path });
+    }
+
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> failed = false;
+    auto work = [&]() -> std::string {
+        for (size_t i; !failed && (i = next++) < pending.size();) {
+            auto& entry = *pending[i].first;
+            auto& path = pending[i].second;
+            auto res = extractMapped(target, zip, entry, path);
+            if (!res) {
+                failed = true;
+                return res.error();
+            }
+            if (index) {
+                index->record(path, entry.m_crc, entry.m_size);
+            }
+        }
+        return "";
+    };
+
+    auto threadCount = getThreadCount(pending.size(), options);
+    std::vector<std::string> errors(threadCount);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++) {
+        threads.emplace_back([&, i]() -> void {
+            errors[i] = work();
+        });
+    }
+    errors[0] = work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& error : errors) {
+        if (error.size()) return Err(error);
+    }
+    return Ok();
+}
+
+/**
+ * Extract every file entry that no other 
+ * worker has claimed yet, to the path 
+ * worked out for it beforehand
+ */
+static Result<> unzipWorker(
+    ghc::filesystem::path const& zipLocation,
+    ExtractTarget& target,
+    std::vector<ghc::filesystem::path> const& paths,
+    ExtractIndex* index,
+    std::vector<std::atomic<bool>>& claimed,
+    std::atomic<bool>& failed
+) {
+    // every worker walks the central directory with 
+    // its own stream & inflates the entries no other 
+    // worker has taken yet
+    wxFileInputStream fis(zipLocation.wstring());
+    if (!fis.IsOk()) {
+        failed = true;
+        return Err("Unable to open zip");
+    }
+    wxZipInputStream zip(fis);
+    std::unique_ptr<wxZipEntry> entry;
+    for (size_t i = 0; entry.reset(zip.GetNextEntry()), entry; i++) {
+        if (failed) break;
+        if (entry->IsDir() || i >= claimed.size() || claimed[i].exchange(true)) {
+            continue;
+        }
+        auto& path = paths[i];
+        if (!zip.CanRead()) {
+            failed = true;
+            return Err(
+                "Unable to read the zip entry \"" +
+                entry->GetName().ToStdString() + "\""
+            );
+        }
+        auto size = static_cast<size_t>(entry->GetSize());
+        uint32_t crc = 0;
+        size_t written = 0;
+        auto res = extractEntry(target, zip, path, size, crc, written);
+        if (!res) {
+            failed = true;
+            return Err("Unable to extract \"" + entry->GetName().ToStdString() + "\": " + res.error());
+        }
+        if (crc != entry->GetCrc() || written != size) {
+            failed = true;
+            return Err("Zip entry \"" + entry->GetName().ToStdString() + "\" is corrupted");
+        }
+        if (index) {
+            index->record(path, entry->GetCrc(), static_cast<size_t>(entry->GetSize()));
+        }
+    }
+    if (zip.GetLastError() == wxSTREAM_READ_ERROR) {
+        failed = true;
+        return Err("Unable to read zip");
+    }
+    return Ok();
+}
+
+static Result<> untarFrom(
+    wxInputStream& stream,
+    ExtractTarget& target,
+    ghc::filesystem::path const& targetLocation,
+    ExtractIndex* index
+) {
+    wxTarInputStream tar(stream);
+    if (!tar.IsOk()) {
+        return Err("Unable to read tar");
+    }
+    DirectoryCache dirs(target, targetLocation);
+    std::unique_ptr<wxTarEntry> entry;
+    while (entry.reset(tar.GetNextEntry()), entry) {
+        auto name = entry->GetInternalName().utf8_string();
+        if (entry->IsDir()) {
+            auto dir = dirs.getDirectory(name);
+            if (!dir) return Err(dir.error());
+            continue;
+        }
+        // links & special files aren't 
+        // part of any release
+        if (entry->GetTypeFlag() != wxTAR_REGTYPE && entry->GetTypeFlag() != wxTAR_AREGTYPE) {
+            continue;
+        }
+        auto file = dirs.getFile(name);
+        if (!file) return Err(file.error());
+        auto path = file.value();
+        auto size = static_cast<size_t>(entry->GetSize());
+        uint32_t crc = 0;
+        size_t written = 0;
+        auto res = extractEntry(target, tar, path, size, crc, written);
+        if (stream.GetLastError() == wxSTREAM_READ_ERROR) {
+            break;
+        }
+        if (!res) return res;
+        if (written != size) {
+            return Err("Tar entry \"" + entry->GetName().ToStdString() + "\" is truncated");
+        }
+        if (index) {
+            index->record(path, crc, written);
+        }
+    }
+    if (
+        stream.GetLastError() == wxSTREAM_READ_ERROR ||
+        tar.GetLastError() == wxSTREAM_READ_ERROR
+    ) {
+        return Err("Unable to read tar");
+    }
+    return Ok();
+}
+
+/**
+ * Extract a .tar.zst archive. Decoding runs 
+ * on its own thread ahead of the one 
+ * writing the files
+ */
+static Result<> untarZstd(
+    wxInputStream& stream,
+    ExtractTarget& target,
+    ghc::filesystem::path const& targetLocation,
+    ExtractIndex* index
+) {
+    #ifdef GEODE_HAS_ZSTD
+    // zstd can't split the decoding of one frame 
+    // over threads, so instead it runs ahead of 
+    // the thread that's busy writing files
+    PipeInputStream pipe;
+    std::thread decoder([&]() -> void {
+        ZstdInputStream zstd(stream);
+        char buffer[0x40000];
+        while (zstd.Read(buffer, sizeof(buffer)).LastRead()) {
+            pipe.write(buffer, zstd.LastRead());
+        }
+        if (zstd.GetLastError() == wxSTREAM_EOF) {
+            pipe.close();
+        } else {
+            pipe.fail();
+        }
+    });
+    auto res = untarFrom(pipe, target, targetLocation, index);
+    decoder.join();
+    if (pipe.hasFailed()) {
+        return Err("Unable to decompress archive");
+    }
+    return res;
+    #else
+    return Err("This build of the installer can't extract .tar.zst archives");
+    #endif
+}
+
+Result<> extractArchive(
+    ghc::filesystem::path const& zipLocation,
+    ExtractTarget& target,
+    ghc::filesystem::path const& targetLocation,
+    ExtractIndex* index,
+    ghc::filesystem::path const& current,
+    ExtractOptions const& options
+) {
+    // the index only knows about files on disk
+    if (!target.isOnDisk()) {
+        index = nullptr;
+    }
+    char magic[4] = {};
+    std::ifstream(zipLocation, std::ios::binary).read(magic, sizeof(magic));
+    if (isZstdData(magic, sizeof(magic))) {
+        wxFileInputStream fis(zipLocation.wstring());
+        if (!fis.IsOk()) {
+            return Err("Unable to open archive");
+        }
+        return untarZstd(fis, target, targetLocation, index);
+    }
+
+    MappedZip mapped;
+    if (options.m_mapped && mapped.open(zipLocation)) {
+        return unzipMapped(mapped, target, targetLocation, index, current, options);
+    }
+
+    // entries that don't need extracting are 
+    // claimed before the workers start
+    std::vector<bool> skip;
+    std::vector<ghc::filesystem::path> paths;
+    size_t count = 0;
+    {
+        wxFileInputStream fis(zipLocation.wstring());
+        if (!fis.IsOk()) {
+            return Err("Unable to open zip");
+        }
+        wxZipInputStream zip(fis);
+        if (!zip.IsOk()) {
+            return Err("Unable to read zip");
+        }
+        // create all directories & work out every 
+        // path up front so the workers only have 
+        // to write files
+        DirectoryCache dirs(target, targetLocation);
+        std::unique_ptr<wxZipEntry> entry;
+        while (entry.reset(zip.GetNextEntry()), entry) {
+            auto name = entry->GetInternalName().utf8_string();
+            if (entry->IsDir()) {
+                auto dir = dirs.getDirectory(name);
+                if (!dir) return Err(dir.error());
+                skip.push_back(true);
+                paths.push_back(dir.value());
+                continue;
+            }
+            auto path = dirs.getFile(name);
+            if (!path) return Err(path.error());
+            auto unchanged = false;
+            if (index) {
+                auto crc = entry->GetCrc();
+                auto size = static_cast<size_t>(entry->GetSize());
+                auto source = current.empty() ?
+                    path.value() : current / ghc::filesystem::path(name);
+                unchanged =
+                    index->isUnchanged(source, crc, size) &&
+                    (source == path.value() || reuseFile(source, path.value(), index, crc, size));
+            }
+            skip.push_back(unchanged);
+            paths.push_back(path.value());
+            if (!unchanged) count++;
+        }
+        if (zip.GetLastError() == wxSTREAM_READ_ERROR) {
+            return Err("Unable to read zip");
+        }
+    }
+    std::vector<std::atomic<bool>> claimed(skip.size());
+    for (size_t i = 0; i < skip.size(); i++) {
+        claimed[i] = skip[i];
+    }
+
+    auto threadCount = getThreadCount(count, options);
+    std::atomic<bool> failed = false;
+    if (threadCount == 1) {
+        return unzipWorker(zipLocation, target, paths, index, claimed, failed);
+    }
+    std::vector<std::string> errors(threadCount);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; i++) {
+        threads.emplace_back([&, i]() -> void {
+            auto res = unzipWorker(zipLocation, target, paths, index, claimed, failed);
+            if (!res) errors[i] = res.error();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& error : errors) {
+        if (error.size()) return Err(error);
+    }
+    return Ok();
+}
+
+Result<> extractStream(
+    wxInputStream& stream,
+    ExtractTarget& target,
+    ghc::filesystem::path const& targetLocation,
+    ExtractIndex* index,
+    ghc::filesystem::path const& current
+) {
+    if (!target.isOnDisk()) {
+        index = nullptr;
+    }
+    char magic[4];
+    stream.Read(magic, sizeof(magic));
+    auto peeked = stream.LastRead();
+    stream.Ungetch(magic, peeked);
+    if (isZstdData(magic, peeked)) {
+        return untarZstd(stream, target, targetLocation, index);
+    }
+
+    wxZipInputStream zip(stream);
+    if (!zip.IsOk()) {
+        return Err("Unable to read zip");
+    }
+    DirectoryCache dirs(target, targetLocation);
+    std::unique_ptr<wxZipEntry> entry;
+    while (entry.reset(zip.GetNextEntry()), entry) {
+        auto name = entry->GetInternalName().utf8_string();
+        if (entry->IsDir()) {
+            auto dir = dirs.getDirectory(name);
+            if (!dir) return Err(dir.error());
+            continue;
+        }
+        auto file = dirs.getFile(name);
+        if (!file) return Err(file.error());
+        auto path = file.value();
+
+        if (!zip.CanRead()) {
+            return Err(
+                "Unable to read the zip entry \"" +
+                entry->GetName().ToStdString() + "\""
+            );
+        }
+
+        // entries followed by a data descriptor 
+        // don't know their size yet
+        auto size = entry->GetSize();
+        auto known = !(entry->GetFlags() & wxZIP_SUMS_FOLLOW);
+        if (index && known) {
+            auto source = current.empty() ?
+                path : current / ghc::filesystem::path(name);
+            auto expected = static_cast<size_t>(size);
+            if (
+                index->isUnchanged(source, entry->GetCrc(), expected) &&
+                (source == path || reuseFile(source, path, index, entry->GetCrc(), expected))
+            ) {
+                // the next entry is read past this one's data
+                continue;
+            }
+        }
+        uint32_t crc = 0;
+        size_t written = 0;
+        auto res = extractEntry(
+            target, zip, path, known && size > 0 ? static_cast<size_t>(size) : 0, crc, written
+        );
+
+        if (stream.GetLastError() == wxSTREAM_READ_ERROR) {
+            break;
+        }
+        if (!res) return res;
+        // streamed entries may only get their CRC 
+        // after the data, which wx checks itself
+        if (known && (crc != entry->GetCrc() || written != static_cast<size_t>(size))) {
+            return Err("Zip entry \"" + entry->GetName().ToStdString() + "\" is corrupted");
+        }
+        if (index) {
+            index->record(path, crc, written);
+        }
+    }
+    // when streaming, a broken download just 
+    // looks like the archive ended early
+    if (
+        stream.GetLastError() == wxSTREAM_READ_ERROR ||
+        zip.GetLastError() == wxSTREAM_READ_ERROR
+    ) {
+        return Err("Unable to read zip");
+    }
+    return Ok();
+}
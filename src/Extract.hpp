@@ -0,0 +1,59 @@
+#pragma once
+
+#include "include/wx.hpp"
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include "ExtractTarget.hpp"
+#include <wx/stream.h>
+
+class ExtractIndex;
+
+struct ExtractOptions {
+    /**
+     * Most threads to inflate zip entries on. 
+     * 0 picks by the number of cores & files
+     */
+    size_t m_threads = 0;
+    /**
+     * Read zips from a mapping of the file when 
+     * it can be mapped. Off, they're read through 
+     * wx's streams, to compare the two
+     */
+    bool m_mapped = true;
+};
+
+/**
+ * Extract a zip or .tar.zst file into the 
+ * target, going by its first bytes. Zip files 
+ * are inflated on several threads, each with 
+ * its own handle to the archive. With an index, 
+ * files it knows are already identical to the 
+ * zip's are left alone. If current is set, 
+ * those files are looked up there & linked 
+ * into the new tree. The index is ignored for 
+ * targets not on disk
+ */
+Result<> extractArchive(
+    ghc::filesystem::path const& archive,
+    ExtractTarget& target,
+    ghc::filesystem::path const& to,
+    ExtractIndex* index = nullptr,
+    ghc::filesystem::path const& current = ghc::filesystem::path(),
+    ExtractOptions const& options = ExtractOptions()
+);
+
+/**
+ * Extract a zip or .tar.zst archive into 
+ * the target as it's read from the stream. 
+ * Index & current work like in extractArchive 
+ * for zip entries whose CRC & size are known 
+ * before their data; the data of those that 
+ * are reused is read past without inflating
+ */
+Result<> extractStream(
+    wxInputStream& stream,
+    ExtractTarget& target,
+    ghc::filesystem::path const& to,
+    ExtractIndex* index = nullptr,
+    ghc::filesystem::path const& current = ghc::filesystem::path()
+);
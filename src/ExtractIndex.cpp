@@ -0,0 +1,109 @@
+#include "ExtractIndex.hpp"
+#include "include/json.hpp"
+#include <fstream>
+
+ExtractIndex::ExtractIndex(ghc::filesystem::path const& path) : m_path(path) {}
+
+long long ExtractIndex::getModified(ghc::filesystem::path const& file) {
+    std::error_code ec;
+    auto time = ghc::filesystem::last_write_time(file, ec);
+    if (ec) return -1;
+    return static_cast<long long>(time.time_since_epoch().count());
+}
+
+Result<> ExtractIndex::load() {
+    std::lock_guard lock(m_mutex);
+    m_entries.clear();
+    if (!ghc::filesystem::exists(m_path)) {
+        return Ok();
+    }
+    try {
+        std::ifstream ifs(m_path);
+        auto json = nlohmann::json::parse(ifs);
+        for (auto& [file, item] : json.items()) {
+            ExtractIndexEntry entry;
+            entry.m_crc = item["crc"].get<uint32_t>();
+            entry.m_size = item["size"].get<size_t>();
+            entry.m_modified = item["modified"].get<long long>();
+            m_entries.insert({ file, entry });
+        }
+    } catch(std::exception& e) {
+        m_entries.clear();
+        return Err("Unable to parse extract index: " + std::string(e.what()));
+    }
+    return Ok();
+}
+
+Result<> ExtractIndex::save() {
+    std::lock_guard lock(m_mutex);
+    auto dir = m_path.parent_path();
+    if (
+        !ghc::filesystem::exists(dir) &&
+        !ghc::filesystem::create_directories(dir)
+    ) {
+        return Err("Unable to create directory " + dir.string());
+    }
+    auto json = nlohmann::json::object();
+    for (auto& [file, entry] : m_entries) {
+        json[file] = {
+            { "crc", entry.m_crc },
+            { "size", entry.m_size },
+            { "modified", entry.m_modified },
+        };
+    }
+    std::ofstream ofs(m_path);
+    if (!ofs.is_open()) {
+        return Err("Unable to write extract index");
+    }
+    ofs << json.dump();
+    return Ok();
+}
+
+bool ExtractIndex::isUnchanged(ghc::filesystem::path const& file, uint32_t crc, size_t size) {
+    ExtractIndexEntry entry;
+    {
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find(file.string());
+        if (it == m_entries.end()) return false;
+        entry = it->second;
+    }
+    if (entry.m_crc != crc || entry.m_size != size) {
+        return false;
+    }
+    std::error_code ec;
+    auto onDisk = ghc::filesystem::file_size(file, ec);
+    return !ec && onDisk == size && getModified(file) == entry.m_modified;
+}
+
+static bool isInside(std::string const& file, std::string const& dir) {
+    return
+        file.size() > dir.size() &&
+        file.compare(0, dir.size(), dir) == 0 &&
+        (file[dir.size()] == '/' || file[dir.size()] == '\\');
+}
+
+void ExtractIndex::move(ghc::filesystem::path const& from, ghc::filesystem::path const& to) {
+    auto fromDir = from.string();
+    auto toDir = to.string();
+
+    std::lock_guard lock(m_mutex);
+    std::unordered_map<std::string, ExtractIndexEntry> entries;
+    for (auto& [file, entry] : m_entries) {
+        if (isInside(file, fromDir)) {
+            entries[toDir + file.substr(fromDir.size())] = entry;
+        } else if (!isInside(file, toDir)) {
+            entries.insert({ file, entry });
+        }
+    }
+    m_entries = std::move(entries);
+}
+
+void ExtractIndex::record(ghc::filesystem::path const& file, uint32_t crc, size_t size) {
+    ExtractIndexEntry entry;
+    entry.m_crc = crc;
+    entry.m_size = size;
+    entry.m_modified = getModified(file);
+
+    std::lock_guard lock(m_mutex);
+    m_entries[file.string()] = entry;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include <string>
+#include <mutex>
+#include <unordered_map>
+
+struct ExtractIndexEntry {
+    uint32_t m_crc;
+    size_t m_size;
+    /**
+     * Modification time of the file right 
+     * after it was written
+     */
+    long long m_modified;
+};
+
+/**
+ * Files written by the installer with the CRC 
+ * they were written with. If a file is still 
+ * the same size & age it was when it was 
+ * written, it hasn't been touched since, and 
+ * comparing its recorded CRC to the one in the 
+ * zip tells whether it needs to be rewritten
+ */
+class ExtractIndex {
+protected:
+    ghc::filesystem::path m_path;
+    std::unordered_map<std::string, ExtractIndexEntry> m_entries;
+    std::mutex m_mutex;
+
+    static long long getModified(ghc::filesystem::path const& file);
+
+public:
+    ExtractIndex(ghc::filesystem::path const& path);
+
+    Result<> load();
+    Result<> save();
+
+    /**
+     * Whether the file on disk already has 
+     * the given contents. Thread-safe
+     */
+    bool isUnchanged(ghc::filesystem::path const& file, uint32_t crc, size_t size);
+    /**
+     * Remember a file that was just written. 
+     * Thread-safe
+     */
+    void record(ghc::filesystem::path const& file, uint32_t crc, size_t size);
+    /**
+     * Update the entries of a directory that has 
+     * been renamed. Entries that were already 
+     * under the new name are dropped
+     */
+    void move(ghc::filesystem::path const& from, ghc::filesystem::path const& to);
+};
@@ -0,0 +1,139 @@
+#include "ExtractTarget.hpp"
+#include "FileWriter.hpp"
+
+Result<> DiskTarget::createDirectory(ghc::filesystem::path const& path, bool parents) {
+    std::error_code ec;
+    if (parents) {
+        ghc::filesystem::create_directories(path, ec);
+    } else {
+        ghc::filesystem::create_directory(path, ec);
+    }
+    if (ec && !ghc::filesystem::is_directory(path)) {
+        return Err("Unable to create directory " + path.string() + ": " + ec.message());
+    }
+    return Ok();
+}
+
+Result<std::shared_ptr<ExtractFile>> DiskTarget::openFile(
+    ghc::filesystem::path const& path,
+    size_t size
+) {
+    auto file = std::make_shared<FileWriter>();
+    auto res = file->open(path, size);
+    if (!res) return Err(res.error());
+    return Ok<std::shared_ptr<ExtractFile>>(file);
+}
+
+bool DiskTarget::isOnDisk() const {
+    return true;
+}
+
+class MemoryFile : public ExtractFile {
+protected:
+    MemoryTarget& m_target;
+    std::string m_path;
+    std::vector<char> m_data;
+    bool m_closed = false;
+
+public:
+    MemoryFile(MemoryTarget& target, std::string const& path, size_t size)
+      : m_target(target), m_path(path) {
+        m_data.reserve(size);
+    }
+
+    Result<> write(const void* data, size_t size) override {
+        if (m_closed) {
+            return Err("File is not open");
+        }
+        auto bytes = static_cast<const char*>(data);
+        m_data.insert(m_data.end(), bytes, bytes + size);
+        return Ok();
+    }
+
+    Result<> close() override {
+        if (m_closed) return Ok();
+        m_closed = true;
+        std::lock_guard lock(m_target.m_mutex);
+        m_target.m_files[m_path] = std::move(m_data);
+        return Ok();
+    }
+
+    size_t getWritten() const override {
+        return m_data.size();
+    }
+};
+
+Result<> MemoryTarget::createDirectory(ghc::filesystem::path const& path, bool parents) {
+    std::lock_guard lock(m_mutex);
+    auto parent = path.parent_path();
+    if (parents) {
+        for (auto dir = parent; dir.has_relative_path(); dir = dir.parent_path()) {
+            m_directories.insert(dir.generic_string());
+        }
+    } else if (
+        parent.has_relative_path() &&
+        !m_directories.count(parent.generic_string())
+    ) {
+        return Err("Unable to create directory " + path.string() + ": parent doesn't exist");
+    }
+    if (m_files.count(path.generic_string())) {
+        return Err("Unable to create directory " + path.string() + ": it's a file");
+    }
+    m_directories.insert(path.generic_string());
+    return Ok();
+}
+
+Result<std::shared_ptr<ExtractFile>> MemoryTarget::openFile(
+    ghc::filesystem::path const& path,
+    size_t size
+) {
+    {
+        std::lock_guard lock(m_mutex);
+        if (!m_directories.count(path.parent_path().generic_string())) {
+            return Err("Unable to create file \"" + path.string() + "\": no such directory");
+        }
+    }
+    return Ok<std::shared_ptr<ExtractFile>>(
+        std::make_shared<MemoryFile>(*this, path.generic_string(), size)
+    );
+}
+
+bool MemoryTarget::isOnDisk() const {
+    return false;
+}
+
+bool MemoryTarget::hasDirectory(ghc::filesystem::path const& path) const {
+    std::lock_guard lock(m_mutex);
+    return m_directories.count(path.generic_string());
+}
+
+std::vector<char> const* MemoryTarget::getFile(ghc::filesystem::path const& path) const {
+    std::lock_guard lock(m_mutex);
+    auto found = m_files.find(path.generic_string());
+    if (found == m_files.end()) return nullptr;
+    return &found->second;
+}
+
+std::vector<std::string> MemoryTarget::getFileNames() const {
+    std::lock_guard lock(m_mutex);
+    std::vector<std::string> names;
+    for (auto& [name, _] : m_files) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+size_t MemoryTarget::getTotalSize() const {
+    std::lock_guard lock(m_mutex);
+    size_t size = 0;
+    for (auto& [_, data] : m_files) {
+        size += data.size();
+    }
+    return size;
+}
+
+void MemoryTarget::clear() {
+    std::lock_guard lock(m_mutex);
+    m_files.clear();
+    m_directories.clear();
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include <memory>
+#include <mutex>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/**
+ * A file being written by extraction
+ */
+class ExtractFile {
+public:
+    virtual ~ExtractFile() = default;
+
+    virtual Result<> write(const void* data, size_t size) = 0;
+    virtual Result<> close() = 0;
+    virtual size_t getWritten() const = 0;
+};
+
+/**
+ * Where extracted files end up. Directories are 
+ * only created from one thread, files may be 
+ * opened from several at once
+ */
+class ExtractTarget {
+public:
+    virtual ~ExtractTarget() = default;
+
+    /**
+     * Create a directory whose parent exists, 
+     * or with parents set, all of the missing 
+     * ones. It already existing is fine
+     */
+    virtual Result<> createDirectory(
+        ghc::filesystem::path const& path,
+        bool parents = false
+    ) = 0;
+    /**
+     * Create or truncate a file in an existing 
+     * directory. If size is not 0 it's what the 
+     * file is expected to end up as
+     */
+    virtual Result<std::shared_ptr<ExtractFile>> openFile(
+        ghc::filesystem::path const& path,
+        size_t size
+    ) = 0;
+    /**
+     * Whether files end up on the real disk, 
+     * which they need to for the extract index 
+     * & linking unchanged files
+     */
+    virtual bool isOnDisk() const = 0;
+};
+
+class DiskTarget : public ExtractTarget {
+public:
+    Result<> createDirectory(ghc::filesystem::path const& path, bool parents) override;
+    Result<std::shared_ptr<ExtractFile>> openFile(
+        ghc::filesystem::path const& path,
+        size_t size
+    ) override;
+    bool isOnDisk() const override;
+};
+
+/**
+ * Keeps everything in memory, so extraction can 
+ * be timed without disk noise and checked 
+ * without leaving files behind
+ */
+class MemoryTarget : public ExtractTarget {
+protected:
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::vector<char>> m_files;
+    std::set<std::string> m_directories;
+
+    friend class MemoryFile;
+
+public:
+    Result<> createDirectory(ghc::filesystem::path const& path, bool parents) override;
+    Result<std::shared_ptr<ExtractFile>> openFile(
+        ghc::filesystem::path const& path,
+        size_t size
+    ) override;
+    bool isOnDisk() const override;
+
+    bool hasDirectory(ghc::filesystem::path const& path) const;
+    /**
+     * Contents of a file that has been closed, 
+     * or nullptr if there is none
+     */
+    std::vector<char> const* getFile(ghc::filesystem::path const& path) const;
+    std::vector<std::string> getFileNames() const;
+    size_t getTotalSize() const;
+    void clear();
+};
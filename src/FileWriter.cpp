@@ -0,0 +1,222 @@
+#include "FileWriter.hpp"
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// bytes gathered before a write call
+#define FILE_WRITER_BUFFER (1024 * 1024)
+// smaller files aren't worth the extra 
+// call to reserve space for them
+#define FILE_WRITER_MIN_PREALLOCATE (256 * 1024)
+// buffers kept around per thread for the 
+// next writers opened on it
+#define FILE_WRITER_SPARE_BUFFERS 4
+
+static std::atomic<size_t> g_files = 0;
+static std::atomic<size_t> g_writes = 0;
+static std::atomic<size_t> g_preallocations = 0;
+static std::atomic<size_t> g_truncates = 0;
+static std::atomic<size_t> g_closes = 0;
+static std::atomic<size_t> g_bytes = 0;
+static std::atomic<size_t> g_bufferedBytes = 0;
+
+static thread_local std::vector<std::unique_ptr<char[]>> t_spareBuffers;
+
+static std::unique_ptr<char[]> takeBuffer() {
+    if (t_spareBuffers.empty()) {
+        return std::unique_ptr<char[]>(new char[FILE_WRITER_BUFFER]);
+    }
+    auto buffer = std::move(t_spareBuffers.back());
+    t_spareBuffers.pop_back();
+    return buffer;
+}
+
+static void giveBackBuffer(std::unique_ptr<char[]> buffer) {
+    if (buffer && t_spareBuffers.size() < FILE_WRITER_SPARE_BUFFERS) {
+        t_spareBuffers.push_back(std::move(buffer));
+    }
+}
+
+size_t FileWriterStats::getSyscalls() const {
+    return m_files + m_writes + m_preallocations + m_truncates + m_closes;
+}
+
+FileWriter::~FileWriter() {
+    this->close();
+}
+
+Result<> FileWriter::open(ghc::filesystem::path const& path, size_t size) {
+    this->close();
+    m_path = path;
+    m_buffered = 0;
+    m_written = 0;
+    m_expected = size;
+    m_preallocated = false;
+
+    #ifdef _WIN32
+    auto handle = CreateFileW(
+        path.wstring().c_str(), GENERIC_WRITE, 0,
+        nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (handle == INVALID_HANDLE_VALUE) {
+        return Err("Unable to create file \"" + path.string() + "\"");
+    }
+    m_handle = handle;
+    #else
+    m_fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (m_fd < 0) {
+        return Err("Unable to create file \"" + path.string() + "\"");
+    }
+    #endif
+    g_files++;
+    m_open = true;
+
+    if (size >= FILE_WRITER_MIN_PREALLOCATE) {
+        this->preallocate(size);
+    }
+    return Ok();
+}
+
+void FileWriter::preallocate(size_t size) {
+    // only a hint, so failures are ignored
+    #ifdef _WIN32
+    FILE_ALLOCATION_INFO info;
+    info.AllocationSize.QuadPart = static_cast<LONGLONG>(size);
+    m_preallocated = SetFileInformationByHandle(
+        m_handle, FileAllocationInfo, &info, sizeof(info)
+    );
+    #elif defined(__APPLE__)
+    fstore_t store = { F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, static_cast<off_t>(size), 0 };
+    if (fcntl(m_fd, F_PREALLOCATE, &store) == -1) {
+        store.fst_flags = F_ALLOCATEALL;
+        m_preallocated = fcntl(m_fd, F_PREALLOCATE, &store) != -1;
+    } else {
+        m_preallocated = true;
+    }
+    #else
+    // this one changes the file size, which 
+    // close() sets back to what was written
+    m_preallocated = posix_fallocate(m_fd, 0, static_cast<off_t>(size)) == 0;
+    #endif
+    if (m_preallocated) {
+        g_preallocations++;
+    }
+}
+
+Result<> FileWriter::writeDirect(const void* data, size_t size) {
+    auto bytes = static_cast<const char*>(data);
+    while (size) {
+        #ifdef _WIN32
+        DWORD chunk = static_cast<DWORD>(std::min<size_t>(size, 0x40000000));
+        DWORD done = 0;
+        if (!WriteFile(m_handle, bytes, chunk, &done, nullptr) || !done) {
+            return Err("Unable to write to \"" + m_path.string() + "\"");
+        }
+        #else
+        auto done = ::write(m_fd, bytes, size);
+        if (done <= 0) {
+            return Err("Unable to write to \"" + m_path.string() + "\"");
+        }
+        #endif
+        g_writes++;
+        bytes += done;
+        size -= static_cast<size_t>(done);
+        m_written += static_cast<size_t>(done);
+    }
+    return Ok();
+}
+
+Result<> FileWriter::flush() {
+    if (!m_buffered) return Ok();
+    auto size = m_buffered;
+    m_buffered = 0;
+    return this->writeDirect(m_buffer.get(), size);
+}
+
+Result<> FileWriter::write(const void* data, size_t size) {
+    if (!m_open) {
+        return Err("File is not open");
+    }
+    g_bytes += size;
+    // big blocks & the whole rest of the 
+    // file go out as they are
+    if (
+        size >= FILE_WRITER_BUFFER ||
+        (!m_buffered && m_expected && m_written + size >= m_expected)
+    ) {
+        auto res = this->flush();
+        if (!res) return res;
+        return this->writeDirect(data, size);
+    }
+    if (m_buffered + size > FILE_WRITER_BUFFER) {
+        auto res = this->flush();
+        if (!res) return res;
+    }
+    // only taken once something needs 
+    // buffering, so files written in one 
+    // big block never need one
+    if (!m_buffer) {
+        m_buffer = takeBuffer();
+    }
+    std::memcpy(m_buffer.get() + m_buffered, data, size);
+    g_bufferedBytes += size;
+    m_buffered += size;
+    return Ok();
+}
+
+Result<> FileWriter::close() {
+    if (!m_open) return Ok();
+    bool ok = static_cast<bool>(this->flush());
+    m_open = false;
+    giveBackBuffer(std::move(m_buffer));
+    #ifdef _WIN32
+    ok = CloseHandle(m_handle) && ok;
+    m_handle = nullptr;
+    #else
+    if (m_preallocated) {
+        ok = ftruncate(m_fd, static_cast<off_t>(m_written)) == 0 && ok;
+        g_truncates++;
+    }
+    ok = ::close(m_fd) == 0 && ok;
+    m_fd = -1;
+    #endif
+    g_closes++;
+    if (!ok) {
+        return Err("Unable to write to \"" + m_path.string() + "\"");
+    }
+    return Ok();
+}
+
+size_t FileWriter::getWritten() const {
+    return m_written + m_buffered;
+}
+
+FileWriterStats FileWriter::getStats() {
+    FileWriterStats stats;
+    stats.m_files = g_files;
+    stats.m_writes = g_writes;
+    stats.m_preallocations = g_preallocations;
+    stats.m_truncates = g_truncates;
+    stats.m_closes = g_closes;
+    stats.m_bytes = g_bytes;
+    stats.m_bufferedBytes = g_bufferedBytes;
+    return stats;
+}
+
+void FileWriter::resetStats() {
+    g_files = 0;
+    g_writes = 0;
+    g_preallocations = 0;
+    g_truncates = 0;
+    g_closes = 0;
+    g_bytes = 0;
+    g_bufferedBytes = 0;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include "ExtractTarget.hpp"
+#include <cstddef>
+#include <memory>
+
+struct FileWriterStats {
+    size_t m_files = 0;
+    size_t m_writes = 0;
+    size_t m_preallocations = 0;
+    /**
+     * Calls setting the size of preallocated 
+     * files back to what was written
+     */
+    size_t m_truncates = 0;
+    size_t m_closes = 0;
+    size_t m_bytes = 0;
+    /**
+     * Bytes that were copied into a buffer 
+     * before being written
+     */
+    size_t m_bufferedBytes = 0;
+
+    /**
+     * Every file system call made, opening & 
+     * closing included
+     */
+    size_t getSyscalls() const;
+};
+
+/**
+ * Output file for extraction. Space for the 
+ * whole file is reserved up front when its size 
+ * is known, and small writes are gathered into 
+ * a large buffer so a typical file takes one 
+ * write call. Each open writer has a buffer of 
+ * its own, taken from those that writers closed 
+ * earlier on the same thread left behind. A 
+ * write that finishes the file on its own, like 
+ * a stored entry handed over from a mapping, 
+ * goes out without being copied
+ */
+class FileWriter : public ExtractFile {
+protected:
+    ghc::filesystem::path m_path;
+    #ifdef _WIN32
+    void* m_handle = nullptr;
+    #else
+    int m_fd = -1;
+    #endif
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_buffered = 0;
+    size_t m_written = 0;
+    size_t m_expected = 0;
+    bool m_preallocated = false;
+    bool m_open = false;
+
+    Result<> flush();
+    Result<> writeDirect(const void* data, size_t size);
+    void preallocate(size_t size);
+
+public:
+    FileWriter() = default;
+    FileWriter(FileWriter const&) = delete;
+    FileWriter& operator=(FileWriter const&) = delete;
+    ~FileWriter() override;
+
+    /**
+     * Create or truncate the file. If size is 
+     * not 0 it's what the file is expected to 
+     * end up as
+     */
+    Result<> open(ghc::filesystem::path const& path, size_t size = 0);
+    Result<> write(const void* data, size_t size) override;
+    /**
+     * Write out anything buffered & close the 
+     * file. Errors from the last writes only 
+     * show up here
+     */
+    Result<> close() override;
+    size_t getWritten() const override;
+
+    /**
+     * Totals across all writers since the 
+     * last reset, for profiling extraction
+     */
+    static FileWriterStats getStats();
+    static void resetStats();
+};
@@ -0,0 +1,482 @@
+#include "FixtureServer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using Socket = SOCKET;
+using SocketLength = int;
+#define NO_SOCKET INVALID_SOCKET
+#define closeSocket closesocket
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+using Socket = int;
+using SocketLength = socklen_t;
+#define NO_SOCKET -1
+#define closeSocket close
+#endif
+
+#define FIXTURE_CHUNK_SIZE 16384
+#define FIXTURE_MAX_HEADER_SIZE 16384
+// in ms, how long the accept & connection 
+// threads wait before checking if they 
+// should stop
+#define FIXTURE_POLL 200
+
+static bool initSockets() {
+    #ifdef _WIN32
+    static bool ok = []() -> bool {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return ok;
+    #else
+    return true;
+    #endif
+}
+
+static void setReceiveTimeout(Socket socket, int ms) {
+    #ifdef _WIN32
+    DWORD timeout = ms;
+    #else
+    timeval timeout {};
+    timeout.tv_sec = ms / 1000;
+    timeout.tv_usec = (ms % 1000) * 1000;
+    #endif
+    setsockopt(
+        socket, SOL_SOCKET, SO_RCVTIMEO,
+        reinterpret_cast<const char*>(&timeout), sizeof(timeout)
+    );
+}
+
+/**
+ * Whether the last failed receive 
+ * ran into the receive timeout
+ */
+static bool timedOut() {
+    #ifdef _WIN32
+    return WSAGetLastError() == WSAETIMEDOUT;
+    #else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+    #endif
+}
+
+static bool waitForAccept(Socket socket, int ms) {
+    fd_set set;
+    FD_ZERO(&set);
+    FD_SET(socket, &set);
+    timeval timeout {};
+    timeout.tv_sec = ms / 1000;
+    timeout.tv_usec = (ms % 1000) * 1000;
+    return select(static_cast<int>(socket) + 1, &set, nullptr, nullptr, &timeout) > 0;
+}
+
+static bool sendAll(Socket socket, const char* data, size_t size) {
+    while (size) {
+        auto sent = send(socket, data, static_cast<int>(size), 0);
+        if (sent <= 0) return false;
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+static void sendStatus(Socket socket, int status, std::string const& text) {
+    auto response =
+        "HTTP/1.1 " + std::to_string(status) + " " + text + "\r\n"
+        "Content-Length: 0\r\n"
+        "Connection: close\r\n\r\n";
+    sendAll(socket, response.data(), response.size());
+}
+
+static std::string lower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) -> char {
+        return static_cast<char>(std::tolower(c));
+    });
+    return str;
+}
+
+/**
+ * Split a response or request head into its 
+ * first line & its headers by lowercase name
+ */
+static std::string parseHead(
+    std::string const& head,
+    std::map<std::string, std::string>& headers
+) {
+    std::istringstream ss(head);
+    std::string first;
+    std::getline(ss, first);
+    if (first.size() && first.back() == '\r') first.pop_back();
+    std::string line;
+    while (std::getline(ss, line)) {
+        if (line.size() && line.back() == '\r') line.pop_back();
+        auto colon = line.find(':');
+        if (colon == std::string::npos) continue;
+        auto value = line.find_first_not_of(' ', colon + 1);
+        headers[lower(line.substr(0, colon))] =
+            value == std::string::npos ? "" : line.substr(value);
+    }
+    return first;
+}
+
+FixtureServer::FixtureServer(FixtureServerOptions const& options)
+  : m_options(options), m_random(std::random_device()()) {}
+
+FixtureServer::FixtureServer(
+    ghc::filesystem::path const& root,
+    FixtureServerOptions const& options
+) : m_root(root), m_options(options), m_random(std::random_device()()) {}
+
+FixtureServer::~FixtureServer() {
+    this->stop();
+}
+
+Result<> FixtureServer::start() {
+    if (m_running) return Ok();
+    if (!m_root.empty() && !ghc::filesystem::is_directory(m_root)) {
+        return Err("Fixture directory " + m_root.string() + " doesn't exist");
+    }
+    if (!initSockets()) {
+        return Err("Unable to initialize sockets");
+    }
+    Socket sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == NO_SOCKET) {
+        return Err("Unable to open fixture server socket");
+    }
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    SocketLength length = sizeof(addr);
+    if (
+        bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(sock, 16) != 0 ||
+        getsockname(sock, reinterpret_cast<sockaddr*>(&addr), &length) != 0
+    ) {
+        closeSocket(sock);
+        return Err("Unable to listen on the loopback interface");
+    }
+    m_socket = static_cast<intptr_t>(sock);
+    m_port = ntohs(addr.sin_port);
+
+    m_running = true;
+    m_acceptThread = std::thread(&FixtureServer::acceptLoop, this);
+    return Ok();
+}
+
+void FixtureServer::stop() {
+    if (!m_running) return;
+    m_running = false;
+    if (m_acceptThread.joinable()) {
+        m_acceptThread.join();
+    }
+    this->joinConnections(true);
+    closeSocket(static_cast<Socket>(m_socket));
+    m_socket = -1;
+}
+
+std::string FixtureServer::getURL() const {
+    return "http://127.0.0.1:" + std::to_string(m_port);
+}
+
+unsigned short FixtureServer::getPort() const {
+    return m_port;
+}
+
+size_t FixtureServer::getRequestCount() const {
+    return m_requestCount;
+}
+
+void FixtureServer::setFile(std::string const& body, std::string const& etag) {
+    std::lock_guard lock(m_mutex);
+    m_hasFile = true;
+    m_body = body;
+    m_etag = etag;
+}
+
+void FixtureServer::cutNextAfter(size_t bytes) {
+    std::lock_guard lock(m_mutex);
+    m_cutAfter = bytes;
+}
+
+void FixtureServer::stallNextAfter(size_t bytes) {
+    std::lock_guard lock(m_mutex);
+    m_stallAfter = bytes;
+}
+
+std::vector<std::string> FixtureServer::getRanges() {
+    std::lock_guard lock(m_mutex);
+    return m_ranges;
+}
+
+bool FixtureServer::roll(double chance) {
+    if (chance <= 0.0) return false;
+    std::lock_guard lock(m_mutex);
+    return std::uniform_real_distribution<double>(0.0, 1.0)(m_random) < chance;
+}
+
+void FixtureServer::sleepUntil(std::chrono::steady_clock::time_point time) {
+    while (m_running && std::chrono::steady_clock::now() < time) {
+        std::this_thread::sleep_until(std::min(
+            time, std::chrono::steady_clock::now() + std::chrono::milliseconds(FIXTURE_POLL)
+        ));
+    }
+}
+
+void FixtureServer::joinConnections(bool all) {
+    auto it = m_connections.begin();
+    while (it != m_connections.end()) {
+        if (all || *it->m_done) {
+            it->m_thread.join();
+            it = m_connections.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void FixtureServer::acceptLoop() {
+    auto server = static_cast<Socket>(m_socket);
+    while (m_running) {
+        this->joinConnections(false);
+        if (!waitForAccept(server, FIXTURE_POLL)) continue;
+        Socket sock = accept(server, nullptr, nullptr);
+        if (sock == NO_SOCKET) continue;
+        // connections are independent and 
+        // may be slowed down on purpose
+        FixtureConnection connection;
+        connection.m_done = std::make_shared<std::atomic<bool>>(false);
+        connection.m_thread = std::thread([this, sock, done = connection.m_done]() -> void {
+            this->handleConnection(static_cast<intptr_t>(sock));
+            closeSocket(sock);
+            *done = true;
+        });
+        m_connections.push_back(std::move(connection));
+    }
+}
+
+void FixtureServer::handleConnection(intptr_t handle) {
+    auto socket = static_cast<Socket>(handle);
+    setReceiveTimeout(socket, FIXTURE_POLL);
+
+    std::string head;
+    char buffer[FIXTURE_CHUNK_SIZE];
+    while (head.find("\r\n\r\n") == std::string::npos) {
+        if (!m_running || head.size() > FIXTURE_MAX_HEADER_SIZE) return;
+        auto got = recv(socket, buffer, sizeof(buffer), 0);
+        if (got < 0 && timedOut()) continue;
+        if (got <= 0) return;
+        head.append(buffer, got);
+    }
+    m_requestCount++;
+
+    std::map<std::string, std::string> headers;
+    std::istringstream first(parseHead(head.substr(0, head.find("\r\n\r\n")), headers));
+    std::string method, target, version;
+    if (!(first >> method >> target >> version)) {
+        return sendStatus(socket, 400, "Bad Request");
+    }
+    if (m_options.m_latency > 0) {
+        this->sleepUntil(
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(m_options.m_latency)
+        );
+    }
+    if (this->roll(m_options.m_errorRate)) {
+        return sendStatus(socket, 500, "Internal Server Error");
+    }
+    if (method != "GET" && method != "HEAD") {
+        return sendStatus(socket, 405, "Method Not Allowed");
+    }
+
+    std::unique_lock lock(m_mutex);
+    auto hasFile = m_hasFile;
+    auto body = m_body;
+    auto etag = m_etag;
+    auto cutAfter = m_cutAfter;
+    auto stallAfter = m_stallAfter;
+    m_cutAfter = 0;
+    m_stallAfter = 0;
+    m_ranges.push_back(headers["range"]);
+    lock.unlock();
+
+    ghc::filesystem::path file;
+    long long size = static_cast<long long>(body.size());
+    if (!hasFile) {
+        auto path = target.substr(0, target.find('?'));
+        file = (m_root / ghc::filesystem::path(path).relative_path()).lexically_normal();
+        auto relative = file.lexically_relative(m_root).string();
+        if (
+            m_root.empty() || relative.empty() || relative.rfind("..", 0) == 0 ||
+            !ghc::filesystem::is_regular_file(file)
+        ) {
+            return sendStatus(socket, 404, "Not Found");
+        }
+        size = static_cast<long long>(ghc::filesystem::file_size(file));
+        auto modified = ghc::filesystem::last_write_time(file).time_since_epoch().count();
+        etag = "\"" + std::to_string(size) + "-" + std::to_string(modified) + "\"";
+    }
+
+    auto& ifNoneMatch = headers["if-none-match"];
+    if (ifNoneMatch.size() && ifNoneMatch == etag) {
+        auto response =
+            "HTTP/1.1 304 Not Modified\r\n"
+            "ETag: " + etag + "\r\n"
+            "Connection: close\r\n\r\n";
+        sendAll(socket, response.data(), response.size());
+        return;
+    }
+
+    long long start = 0;
+    long long end = size - 1;
+    bool partial = false;
+    auto& range = headers["range"];
+    auto& ifRange = headers["if-range"];
+    if (range.size() && (ifRange.empty() || ifRange == etag)) {
+        long long firstByte = -1, lastByte = -1;
+        auto count = std::sscanf(range.c_str(), "bytes=%lld-%lld", &firstByte, &lastByte);
+        if (count >= 1 && firstByte >= 0) {
+            if (firstByte >= size) {
+                auto response =
+                    "HTTP/1.1 416 Range Not Satisfiable\r\n"
+                    "Content-Range: bytes */" + std::to_string(size) + "\r\n"
+                    "Content-Length: 0\r\n"
+                    "Connection: close\r\n\r\n";
+                sendAll(socket, response.data(), response.size());
+                return;
+            }
+            start = firstByte;
+            if (count == 2 && lastByte < end) end = lastByte;
+            partial = true;
+        }
+    }
+    auto length = end - start + 1;
+
+    std::string response = partial ?
+        "HTTP/1.1 206 Partial Content\r\n" :
+        "HTTP/1.1 200 OK\r\n";
+    response += "Content-Length: " + std::to_string(length) + "\r\n";
+    if (partial) {
+        response +=
+            "Content-Range: bytes " + std::to_string(start) + "-" +
+            std::to_string(end) + "/" + std::to_string(size) + "\r\n";
+    }
+    response +=
+        "Accept-Ranges: bytes\r\n"
+        "ETag: " + etag + "\r\n"
+        "Content-Type: application/octet-stream\r\n"
+        "Connection: close\r\n\r\n";
+    if (!sendAll(socket, response.data(), response.size()) || method == "HEAD") {
+        return;
+    }
+
+    // how much of the body actually gets sent
+    auto limit = length;
+    if (this->roll(m_options.m_dropRate)) {
+        limit = length / 2;
+    }
+    if (cutAfter && static_cast<long long>(cutAfter) < limit) {
+        limit = static_cast<long long>(cutAfter);
+    }
+    bool stall = stallAfter && static_cast<long long>(stallAfter) < limit;
+    if (stall) {
+        limit = static_cast<long long>(stallAfter);
+    }
+
+    std::ifstream ifs;
+    if (!hasFile) {
+        ifs.open(file, std::ios::binary);
+        ifs.seekg(start);
+    }
+    auto began = std::chrono::steady_clock::now();
+    long long sent = 0;
+    while (sent < limit && m_running) {
+        auto chunk = std::min<long long>(sizeof(buffer), limit - sent);
+        const char* data = body.data() + start + sent;
+        if (!hasFile) {
+            if (!ifs.read(buffer, chunk)) return;
+            data = buffer;
+        }
+        if (!sendAll(socket, data, static_cast<size_t>(chunk))) return;
+        sent += chunk;
+        if (m_options.m_bandwidth > 0) {
+            this->sleepUntil(
+                began + std::chrono::microseconds(sent * 1000000 / m_options.m_bandwidth)
+            );
+        }
+    }
+    if (!stall) return;
+
+    // wait for the client to hang up
+    while (m_running) {
+        auto got = recv(socket, buffer, sizeof(buffer), 0);
+        if (got == 0 || (got < 0 && !timedOut())) break;
+    }
+}
+
+Result<FixtureResponse> fixtureGet(
+    unsigned short port,
+    std::map<std::string, std::string> const& headers,
+    int timeout,
+    std::string const& path
+) {
+    if (!initSockets()) {
+        return Err("Unable to initialize sockets");
+    }
+    Socket sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == NO_SOCKET) {
+        return Err("Unable to create socket");
+    }
+    sockaddr_in addr {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        closeSocket(sock);
+        return Err("Unable to connect to port " + std::to_string(port));
+    }
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: 127.0.0.1\r\n";
+    for (auto& [name, value] : headers) {
+        request += name + ": " + value + "\r\n";
+    }
+    request += "\r\n";
+    if (!sendAll(sock, request.data(), request.size())) {
+        closeSocket(sock);
+        return Err("Unable to send request");
+    }
+    if (timeout > 0) {
+        setReceiveTimeout(sock, timeout);
+    }
+
+    std::string data;
+    char buffer[FIXTURE_CHUNK_SIZE];
+    int got;
+    while ((got = recv(sock, buffer, sizeof(buffer), 0)) > 0) {
+        data.append(buffer, got);
+    }
+    bool stalled = got < 0 && timeout > 0 && timedOut();
+    closeSocket(sock);
+
+    auto end = data.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        return Err("Connection closed before the response head");
+    }
+    FixtureResponse response;
+    auto status = parseHead(data.substr(0, end), response.m_headers);
+    if (std::sscanf(status.c_str(), "HTTP/1.1 %d", &response.m_status) != 1) {
+        return Err("Invalid status line: " + status);
+    }
+    response.m_body = data.substr(end + 4);
+    response.m_complete =
+        std::to_string(response.m_body.size()) == response.m_headers["content-length"];
+    response.m_timedOut = stalled;
+    return Ok(response);
+}
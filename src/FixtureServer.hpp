@@ -0,0 +1,176 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct FixtureServerOptions {
+    /**
+     * Delay before each response is sent, in ms
+     */
+    long long m_latency = 0;
+    /**
+     * Bytes per second per connection, 
+     * 0 for no limit
+     */
+    long long m_bandwidth = 0;
+    /**
+     * Fraction of requests answered with 
+     * a 500 error
+     */
+    double m_errorRate = 0.0;
+    /**
+     * Fraction of responses whose connection is 
+     * closed halfway through the body
+     */
+    double m_dropRate = 0.0;
+};
+
+struct FixtureConnection {
+    std::thread m_thread;
+    std::shared_ptr<std::atomic<bool>> m_done;
+};
+
+/**
+ * Small HTTP server on the loopback interface, 
+ * so the download pipeline can be run without 
+ * the internet and under controlled conditions. 
+ * Only uses the OS' sockets, so the core tests 
+ * can use it as well as the app's fixture mode. 
+ * 
+ * It either serves a directory of fixture files 
+ * laid out like mirror URLs, i.e. 
+ * <root>/<host>/<path>, so it can stand in for 
+ * the mirrors & the real hosts, or one file 
+ * set with setFile() at every path. Supports 
+ * GET & HEAD, single byte ranges, If-Range & 
+ * If-None-Match, and can slow down, fail, cut 
+ * off or stall responses on purpose. Each 
+ * connection is handled on its own thread
+ */
+class FixtureServer {
+protected:
+    ghc::filesystem::path m_root;
+    FixtureServerOptions m_options;
+    std::thread m_acceptThread;
+    /**
+     * Threads of open connections. Only the accept 
+     * thread touches this until it has stopped, 
+     * after which stop() joins the rest
+     */
+    std::vector<FixtureConnection> m_connections;
+    std::atomic<bool> m_running = false;
+    std::atomic<size_t> m_requestCount = 0;
+    intptr_t m_socket = -1;
+    unsigned short m_port = 0;
+
+    std::mutex m_mutex;
+    std::mt19937 m_random;
+    bool m_hasFile = false;
+    std::string m_body;
+    std::string m_etag;
+    size_t m_cutAfter = 0;
+    size_t m_stallAfter = 0;
+    std::vector<std::string> m_ranges;
+
+    void acceptLoop();
+    /**
+     * Join the connection threads that have 
+     * finished, or all of them
+     */
+    void joinConnections(bool all);
+    void handleConnection(intptr_t socket);
+    bool roll(double chance);
+    /**
+     * Wait until the given time or until 
+     * the server is stopped
+     */
+    void sleepUntil(std::chrono::steady_clock::time_point time);
+
+public:
+    /**
+     * Serve the file set with setFile()
+     */
+    FixtureServer(FixtureServerOptions const& options = FixtureServerOptions());
+    FixtureServer(ghc::filesystem::path const& root, FixtureServerOptions const& options);
+    ~FixtureServer();
+
+    Result<> start();
+    /**
+     * Stop accepting connections & wait for the 
+     * open ones to finish; responses being sent 
+     * are cut off
+     */
+    void stop();
+
+    /**
+     * Base URL of the server, like 
+     * http://127.0.0.1:12345
+     */
+    std::string getURL() const;
+    unsigned short getPort() const;
+    size_t getRequestCount() const;
+
+    /**
+     * Serve this instead of the fixture 
+     * directory, at every path
+     */
+    void setFile(std::string const& body, std::string const& etag);
+    /**
+     * Close the connection of the next response 
+     * after this many bytes of its body
+     */
+    void cutNextAfter(size_t bytes);
+    /**
+     * Stop sending the next response after this 
+     * many bytes of its body, but keep the 
+     * connection open until the client gives up
+     */
+    void stallNextAfter(size_t bytes);
+    /**
+     * Range header of every request so 
+     * far, empty if it had none
+     */
+    std::vector<std::string> getRanges();
+};
+
+struct FixtureResponse {
+    int m_status = 0;
+    /**
+     * By lowercase name
+     */
+    std::map<std::string, std::string> m_headers;
+    std::string m_body;
+    /**
+     * Whether the body is as long as 
+     * Content-Length said
+     */
+    bool m_complete = false;
+    /**
+     * Whether the server went quiet for 
+     * longer than the timeout
+     */
+    bool m_timedOut = false;
+};
+
+/**
+ * Send a GET request to a server on the loopback 
+ * interface & read the response until the 
+ * connection closes, or until nothing has 
+ * arrived for the timeout in ms if one is given
+ */
+Result<FixtureResponse> fixtureGet(
+    unsigned short port,
+    std::map<std::string, std::string> const& headers = {},
+    int timeout = 0,
+    std::string const& path = "/file"
+);
@@ -240,6 +240,10 @@ MainFrame::MainFrame() : wxFrame(
         return;
     }
 
+    // most people open the installer to 
+    // check for updates
+    Manager::get()->prefetchUpdateMetadata();
+
     this->Bind(wxEVT_LEFT_DOWN, &MainFrame::onMouseLeftDown, this);
     this->Bind(wxEVT_MOUSE_CAPTURE_LOST, &MainFrame::onMouseCaptureLost, this);
     this->Bind(wxEVT_CLOSE_WINDOW, &MainFrame::onClose, this);
@@ -1,14 +1,62 @@
 #include "Manager.hpp"
+#include "PartialDownload.hpp"
+#include "PipeStream.hpp"
+#include "BinaryPatch.hpp"
+#include "ReleaseInfo.hpp"
+#include "FileWriter.hpp"
+#include "Extract.hpp"
+#include "include/SHA256.hpp"
+#include "include/CRC32.hpp"
 #include <fstream>
 #include "objc.h"
-#include <wx/zipstrm.h>
-#include <wx/wfstream.h>
+#include <wx/zstream.h>
 #include <wx/stdpaths.h>
 #include <thread>
 #include <chrono>
 #include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <iomanip>
 
 #define INSTALL_DATA_JSON "config.json"
+#define DOWNLOADS_DIR "downloads"
+#define DOWNLOAD_CACHE_DIR "cache"
+// in megabytes, can be changed with 
+// "download-cache-size" in the config
+#define DOWNLOAD_CACHE_SIZE 256
+#define METADATA_CACHE_JSON "metadata-cache.json"
+// in seconds, can be changed with 
+// "metadata-ttl" in the config
+#define METADATA_TTL 300
+#define DOWNLOAD_ATTEMPTS 3
+#define DOWNLOAD_SEGMENTS 4
+// siblings of the bin directory, so 
+// swapping them in is just a rename
+#define CLI_STAGING_SUFFIX ".staging"
+#define CLI_BACKUP_SUFFIX ".previous"
+// written next to the installed library 
+// & then renamed over it
+#define GEODE_UTILS_TEMP_SUFFIX ".new"
+#define EXTRACT_INDEX_JSON "extract-index.json"
+// files smaller than this per segment aren't 
+// worth the extra requests
+#define MIN_SEGMENT_SIZE (256 * 1024)
+// number of finished requests whose 
+// telemetry is kept around
+#define TELEMETRY_HISTORY 64
+// in ms; a download that receives nothing for 
+// this long is given up on & retried, on 
+// another mirror if there is one
+#define DOWNLOAD_STALL_TIMEOUT 15000
+#define STALL_CHECK_INTERVAL 1000
+// number of requests running at once, can be 
+// changed with "max-requests" in the config
+#define MAX_REQUESTS 6
+// small file every mirror should have
+#define MIRROR_PROBE_URL "https://raw.githubusercontent.com/geode-sdk/suite/main/versions.json"
+// written in the data directory when 
+// running against a fixture server
+#define STAGE_TIMINGS_LOG "stage-timings.log"
 #define GEODE_DIR "Geode"
 #define GEODE_SUITE_ENV "GEODE_SUITE"
 
@@ -20,21 +68,30 @@
 
 #define PLATFORM_ASSET_IDENTIFIER "win"
 #define PLATFORM_NAME "Windows"
+#define GEODE_UTILS_LIB "geodeutils.dll"
 
 #elif defined(__APPLE__)
 
 #include <dlfcn.h>
+#include <stdio.h>
 #include <CoreServices/CoreServices.h>
 #include "objc.h"
 #define PLATFORM_ASSET_IDENTIFIER "mac"
 #define PLATFORM_NAME "MacOS"
+#define GEODE_UTILS_LIB "libgeodeutils.dylib"
 
 #else
-#warning "Define PLATFORM_ASSET_IDENTIFIER & PLATFORM_NAME"
+#warning "Define PLATFORM_ASSET_IDENTIFIER, PLATFORM_NAME & GEODE_UTILS_LIB"
 #endif
 
 wxDEFINE_EVENT(CALL_ON_MAIN, CallOnMainEvent);
 
+Manager::Manager() {
+    this->Bind(CALL_ON_MAIN, &Manager::onSyncThreadCall, this);
+    this->Bind(wxEVT_WEBREQUEST_STATE, &Manager::onWebRequestState, this);
+    this->Bind(wxEVT_WEBREQUEST_DATA, &Manager::onWebRequestData, this);
+}
+
 Manager* Manager::get() {
     static auto m = new Manager;
     return m;
@@ -71,68 +128,1288 @@ Result<> Manager::addSuiteEnv() {
     );
     return Ok();
 
-    #else
+    #else
+
+    // nothing we rly need to do
+    return Ok();
+
+    #endif
+}
+
+
+InstallerMode Manager::getInstallerMode() const {
+    return m_mode;
+}
+
+ghc::filesystem::path const& Manager::getLoaderUpdatePath() const {
+    return m_loaderUpdatePath;
+}
+
+
+wxWebRequest Manager::createRequest(std::string const& url, bool useMirrors) {
+    auto target = useMirrors ? this->getMirrors().resolve(url) : url;
+    // nothing may reach the real hosts when 
+    // running against a fixture server
+    if (m_fixtureServer && target.rfind(m_fixtureServer->getURL() + "/", 0) != 0) {
+        return wxWebRequest();
+    }
+    auto request = this->getSession().CreateRequest(this, target, m_nextRequestID++);
+    if (request.IsOk()) {
+        m_requests.add(request.GetId()).m_telemetry.start(target);
+    }
+    return request;
+}
+
+void Manager::handleRequestState(wxWebRequest const& request, WebRequestEventFunc func) {
+    m_requests.get(request.GetId()).m_stateFunc = func;
+}
+
+void Manager::handleRequestData(wxWebRequest const& request, WebRequestEventFunc func) {
+    m_requests.get(request.GetId()).m_dataFunc = func;
+}
+
+void Manager::handleRequestStall(wxWebRequest const& request, std::function<void()> func) {
+    m_requests.get(request.GetId()).m_stallFunc = func;
+}
+
+wxWebSession& Manager::getSession() {
+    if (!m_session.IsOpened()) {
+        m_session = wxWebSession::New();
+        if (!m_session.IsOpened()) {
+            m_session = wxWebSession::GetDefault();
+        }
+        m_session.AddCommonHeader("Connection", "keep-alive");
+    }
+    return m_session;
+}
+
+size_t Manager::getMaxRequests() const {
+    if (m_loadedConfigJson.contains("max-requests")) {
+        return std::max<size_t>(m_loadedConfigJson["max-requests"].get<size_t>(), 1);
+    }
+    return MAX_REQUESTS;
+}
+
+void Manager::startRequest(wxWebRequest const& request, RequestPriority priority) {
+    m_requests.get(request.GetId()).m_request = request;
+    m_scheduler.enqueue(request.GetId(), priority);
+    this->startQueuedRequests();
+}
+
+void Manager::raiseRequestPriority(wxWebRequest const& request, RequestPriority priority) {
+    m_scheduler.raisePriority(request.GetId(), priority);
+    this->startQueuedRequests();
+}
+
+void Manager::startQueuedRequests() {
+    m_scheduler.setMaxRunning(this->getMaxRequests());
+    int id;
+    while (m_scheduler.startNext(id)) {
+        // skip requests cancelled while waiting
+        auto handlers = m_requests.find(id);
+        if (!handlers || handlers->m_request.GetState() != wxWebRequest::State_Idle) {
+            m_scheduler.finish(id);
+            continue;
+        }
+        handlers->m_telemetry.dispatched();
+        if (handlers->m_stallFunc) {
+            this->startStallTimer(*handlers, id);
+        }
+        handlers->m_request.Start();
+    }
+}
+
+void Manager::startStallTimer(WebRequestHandlers& handlers, int id) {
+    handlers.m_stallTimer = std::make_unique<wxTimer>();
+    handlers.m_stallTimer->Bind(wxEVT_TIMER, [this, id](wxTimerEvent&) -> void {
+        auto handlers = m_requests.find(id);
+        if (!handlers) return;
+        if (handlers->m_telemetry.getIdleTime() < DOWNLOAD_STALL_TIMEOUT) return;
+
+        handlers->m_stallTimer->Stop();
+        handlers->m_telemetry.stalled();
+        // the handler usually cancels the request, 
+        // which destroys this timer
+        auto stallFunc = handlers->m_stallFunc;
+        this->CallAfter([stallFunc]() -> void {
+            if (stallFunc) stallFunc();
+        });
+    });
+    handlers.m_stallTimer->Start(STALL_CHECK_INTERVAL);
+}
+
+void Manager::onWebRequestState(wxWebRequestEvent& evt) {
+    auto handlers = m_requests.find(evt.GetId());
+    if (!handlers) {
+        return evt.Skip();
+    }
+    switch (evt.GetState()) {
+        case wxWebRequest::State_Completed:
+        case wxWebRequest::State_Unauthorized:
+        case wxWebRequest::State_Failed:
+        case wxWebRequest::State_Cancelled: {
+            // nothing more will come from this request, so 
+            // free its handlers before running the last one
+            auto finished = m_requests.finish(evt.GetId());
+            auto func = std::move(finished->m_stateFunc);
+            auto telemetry = std::move(finished->m_telemetry);
+            finished.reset();
+            m_scheduler.finish(evt.GetId());
+            this->startQueuedRequests();
+
+            auto res = evt.GetResponse();
+            telemetry.finish(
+                res.IsOk() ? res.GetStatus() : 0,
+                evt.GetState() != wxWebRequest::State_Completed,
+                evt.GetState() == wxWebRequest::State_Cancelled
+            );
+            this->getMirrors().report(telemetry);
+            this->recordTelemetry(telemetry);
+
+            if (func) func(evt);
+        } break;
+
+        default: {
+            if (handlers->m_stateFunc) handlers->m_stateFunc(evt);
+        } break;
+    }
+}
+
+void Manager::onWebRequestData(wxWebRequestEvent& evt) {
+    auto handlers = m_requests.find(evt.GetId());
+    if (!handlers) {
+        return evt.Skip();
+    }
+    auto& telemetry = handlers->m_telemetry;
+    telemetry.received(
+        evt.GetRequest().GetBytesReceived(),
+        evt.GetRequest().GetBytesExpectedToReceive()
+    );
+    if (m_telemetryFunc) m_telemetryFunc(telemetry);
+
+    if (handlers->m_dataFunc) handlers->m_dataFunc(evt);
+}
+
+size_t Manager::getActiveRequestCount() const {
+    return m_requests.getActiveCount();
+}
+
+size_t Manager::getTotalRequestCount() const {
+    return m_requests.getTotalCount();
+}
+
+DownloadTelemetry const* Manager::getTelemetry(wxWebRequest const& request) const {
+    auto handlers = m_requests.find(request.GetId());
+    if (!handlers) {
+        return nullptr;
+    }
+    return &handlers->m_telemetry;
+}
+
+void Manager::recordTelemetry(DownloadTelemetry const& telemetry) {
+    m_telemetryHistory.push_back(telemetry);
+    if (m_telemetryHistory.size() > TELEMETRY_HISTORY) {
+        m_telemetryHistory.pop_front();
+    }
+    if (m_telemetryFunc) m_telemetryFunc(telemetry);
+}
+
+std::deque<DownloadTelemetry> const& Manager::getTelemetryHistory() const {
+    return m_telemetryHistory;
+}
+
+void Manager::setTelemetryFunc(DownloadTelemetryFunc func) {
+    m_telemetryFunc = func;
+}
+
+std::string Manager::getProgressText(wxWebRequest const& request) const {
+    auto telemetry = this->getTelemetry(request);
+    if (!telemetry) {
+        return "Downloading";
+    }
+    return "Downloading " + telemetry->describe();
+}
+
+/**
+ * Error given for a response with an unexpected 
+ * status, so callers can tell some apart
+ */
+static std::string statusError(int status) {
+    return "Web request returned " + std::to_string(status);
+}
+
+wxWebRequest Manager::webRequest(
+    std::string const& url,
+    DownloadErrorFunc errorFunc,
+    DownloadProgressFunc progressFunc,
+    DownloadFinishFunc finishFunc,
+    std::unordered_map<std::string, std::string> const& headers,
+    RequestPriority priority,
+    WebRequestEventFunc dataFunc
+) {
+    auto request = this->createRequest(url);
+    if (!request.IsOk()) {
+        if (errorFunc) errorFunc("Unable to create web request");
+        return request;
+    }
+    for (auto& [name, value] : headers) {
+        request.SetHeader(name, value);
+    }
+    if (dataFunc) {
+        request.SetStorage(wxWebRequest::Storage_None);
+        this->handleRequestData(request, dataFunc);
+    }
+    this->handleRequestState(
+        request,
+        [errorFunc, progressFunc, finishFunc](wxWebRequestEvent& evt) -> void {
+        switch (evt.GetState()) {
+            case wxWebRequest::State_Completed: {
+                auto res = evt.GetResponse();
+                if (!res.IsOk()) {
+                    if (!errorFunc) return;
+                    return errorFunc("Web request returned not OK");
+                }
+                // 304 only comes back for conditional 
+                // requests, whose callers handle it
+                if (res.GetStatus() != 200 && res.GetStatus() != 304) {
+                    if (!errorFunc) return;
+                    return errorFunc(statusError(res.GetStatus()));
+                }
+                if (finishFunc) finishFunc(res);
+            } break;
+
+            case wxWebRequest::State_Active: {
+                if (!progressFunc) return;
+                if (evt.GetRequest().GetBytesExpectedToReceive() == -1) {
+                    return progressFunc("Beginning download", 0);
+                }
+                progressFunc(
+                    "Downloading",
+                    static_cast<int>(
+                        static_cast<double>(evt.GetRequest().GetBytesReceived()) /
+                        evt.GetRequest().GetBytesExpectedToReceive() * 100.0
+                    )
+                );
+            } break;
+
+            case wxWebRequest::State_Idle: {
+                if (progressFunc) progressFunc("Waiting", 0);
+            } break;
+
+            case wxWebRequest::State_Unauthorized: {
+                if (errorFunc) errorFunc("Unauthorized to do web request");
+            } break;
+
+            case wxWebRequest::State_Failed: {
+                if (errorFunc) errorFunc("Web request failed");
+            } break;
+
+            case wxWebRequest::State_Cancelled: {
+                if (errorFunc) errorFunc("Web request cancelled");
+            } break;
+        }
+    });
+    this->startRequest(request, priority);
+    return request;
+}
+
+/**
+ * Body of a metadata response. Gzipped bodies 
+ * are recognized by their magic bytes, since 
+ * some backends already decode them and others 
+ * don't, and are decoded on a worker thread 
+ * as the data arrives
+ */
+struct MetadataDownloadState {
+    std::shared_ptr<PipeInputStream> m_pipe;
+    std::string m_body;
+    bool m_checked = false;
+    bool m_compressed = false;
+    bool m_decoded = false;
+    bool m_failed = false;
+    std::string m_decodeError;
+    MetadataFinishFunc m_doneFunc;
+    DownloadErrorFunc m_errorFunc;
+
+    MetadataDownloadState() : m_pipe(std::make_shared<PipeInputStream>()) {}
+
+    /**
+     * Returns true once the body turns out to 
+     * be gzipped and needs a decoder
+     */
+    bool received(const void* data, size_t size) {
+        if (m_compressed) {
+            m_pipe->write(data, size);
+            return false;
+        }
+        m_body.append(static_cast<const char*>(data), size);
+        if (m_checked || m_body.size() < 2) return false;
+        m_checked = true;
+        m_compressed =
+            static_cast<unsigned char>(m_body[0]) == 0x1f &&
+            static_cast<unsigned char>(m_body[1]) == 0x8b;
+        if (!m_compressed) return false;
+        m_pipe->write(m_body.data(), m_body.size());
+        m_body.clear();
+        return true;
+    }
+
+    void responseDone(MetadataFinishFunc doneFunc) {
+        if (!m_compressed) {
+            return doneFunc(m_body);
+        }
+        m_doneFunc = doneFunc;
+        m_pipe->close();
+        this->tryFinish();
+    }
+
+    void decoderDone(std::string const& body, std::string const& error) {
+        m_decoded = true;
+        m_body = body;
+        m_decodeError = error;
+        this->tryFinish();
+    }
+
+    void fail() {
+        m_failed = true;
+        m_pipe->fail();
+    }
+
+    void tryFinish() {
+        if (m_failed || !m_decoded || !m_doneFunc) return;
+        auto doneFunc = std::move(m_doneFunc);
+        m_doneFunc = nullptr;
+        if (m_decodeError.size()) {
+            if (m_errorFunc) m_errorFunc(m_decodeError);
+            return;
+        }
+        doneFunc(m_body);
+    }
+};
+
+wxWebRequest Manager::fetchMetadata(
+    std::string const& url,
+    DownloadErrorFunc errorFunc,
+    MetadataFinishFunc finishFunc,
+    RequestPriority priority,
+    bool revalidate
+) {
+    auto& cache = this->getMetadataCache();
+    auto entry = cache.find(url);
+    if (entry && !revalidate && cache.isFresh(*entry)) {
+        auto body = entry->m_body;
+        this->CallAfter([finishFunc, body]() -> void {
+            if (finishFunc) finishFunc(body);
+        });
+        return wxWebRequest();
+    }
+
+    std::unordered_map<std::string, std::string> headers;
+    // release lists are mostly repeated keys 
+    // and shrink a lot when compressed
+    headers["Accept-Encoding"] = "gzip";
+    if (entry && entry->m_etag.size()) {
+        headers["If-None-Match"] = entry->m_etag;
+    }
+    if (entry && entry->m_lastModified.size()) {
+        headers["If-Modified-Since"] = entry->m_lastModified;
+    }
+
+    auto state = std::make_shared<MetadataDownloadState>();
+    state->m_errorFunc = errorFunc;
+
+    return this->webRequest(
+        url,
+        [state, errorFunc](std::string const& error) -> void {
+            state->fail();
+            if (errorFunc) errorFunc(error);
+        },
+        nullptr,
+        [this, url, errorFunc, finishFunc, state](wxWebResponse const& res) -> void {
+            auto& cache = this->getMetadataCache();
+            if (res.GetStatus() == 304) {
+                state->fail();
+                auto entry = cache.revalidated(url);
+                if (!entry) {
+                    if (errorFunc) errorFunc("Web request returned 304");
+                    return;
+                }
+                if (finishFunc) finishFunc(entry->m_body);
+                return;
+            }
+            auto etag = res.GetHeader("ETag").ToStdString();
+            auto lastModified = res.GetHeader("Last-Modified").ToStdString();
+            state->responseDone(
+                [this, url, finishFunc, etag, lastModified](std::string const& body) -> void {
+                    this->getMetadataCache().store(url, body, etag, lastModified);
+                    if (finishFunc) finishFunc(body);
+                }
+            );
+        },
+        headers,
+        priority,
+        [this, state](wxWebRequestEvent& evt) -> void {
+            if (!state->received(evt.GetDataBuffer(), evt.GetDataSize())) return;
+            std::thread([this, state]() -> void {
+                wxZlibInputStream zlib(*state->m_pipe, wxZLIB_GZIP);
+                std::string body;
+                char buffer[0x4000];
+                while (zlib.Read(buffer, sizeof(buffer)).LastRead()) {
+                    body.append(buffer, zlib.LastRead());
+                }
+                std::string error;
+                if (state->m_pipe->hasFailed() || zlib.GetLastError() != wxSTREAM_EOF) {
+                    error = "Unable to decode compressed response";
+                }
+                wxQueueEvent(this, new CallOnMainEvent(
+                    [state, body, error]() -> void {
+                        state->decoderDone(body, error);
+                    },
+                    CALL_ON_MAIN,
+                    wxID_ANY
+                ));
+            }).detach();
+        }
+    );
+}
+
+void Manager::fetchJson(
+    std::string const& url,
+    DownloadErrorFunc errorFunc,
+    JsonFinishFunc finishFunc,
+    RequestPriority priority
+) {
+    auto& pending = m_pendingJson[url];
+    pending.m_callbacks.push_back({ errorFunc, finishFunc });
+    if (pending.m_callbacks.size() > 1) {
+        // someone may now be waiting on a prefetch
+        if (pending.m_request.IsOk()) {
+            this->raiseRequestPriority(pending.m_request, priority);
+        }
+        return;
+    }
+
+    // callbacks may start new fetches of the 
+    // same URL, so take the list out first
+    auto takePending = [this, url]() -> std::vector<JsonRequestCallbacks> {
+        auto callbacks = std::move(m_pendingJson[url].m_callbacks);
+        m_pendingJson.erase(url);
+        return callbacks;
+    };
+
+    auto request = this->fetchMetadata(
+        url,
+        [takePending](std::string const& err) -> void {
+            for (auto& cb : takePending()) {
+                if (cb.m_errorFunc) cb.m_errorFunc(err);
+            }
+        },
+        [takePending](std::string const& body) -> void {
+            auto callbacks = takePending();
+            nlohmann::json json;
+            try {
+                json = nlohmann::json::parse(body);
+            } catch(std::exception& e) {
+                for (auto& cb : callbacks) {
+                    if (cb.m_errorFunc) {
+                        cb.m_errorFunc("Unable to parse JSON: " + std::string(e.what()));
+                    }
+                }
+                return;
+            }
+            for (auto& cb : callbacks) {
+                if (cb.m_finishFunc) cb.m_finishFunc(json);
+            }
+        },
+        priority
+    );
+    // the request can't have finished yet, 
+    // but it may have failed to start
+    auto it = m_pendingJson.find(url);
+    if (it != m_pendingJson.end()) {
+        it->second.m_request = request;
+    }
+}
+
+std::string Manager::getVersionsURL(DevBranch branch) {
+    if (branch == DevBranch::Nightly) {
+        return "https://raw.githubusercontent.com/geode-sdk/suite/nightly/versions.json";
+    }
+    return "https://raw.githubusercontent.com/geode-sdk/suite/main/versions.json";
+}
+
+void Manager::prefetchUpdateMetadata() {
+    std::set<std::string> urls;
+    if (this->isSuiteInstalled()) {
+        urls.insert(getVersionsURL(DevBranch::Stable));
+    }
+    for (auto& inst : m_installations) {
+        urls.insert(getVersionsURL(inst.m_branch));
+    }
+    for (auto& url : urls) {
+        // nobody to report errors to; a real 
+        // check will just try again
+        this->fetchJson(url, nullptr, nullptr, RequestPriority::Speculative);
+    }
+}
+
+void Manager::cancelSpeculativeRequests() {
+    std::vector<wxWebRequest> requests;
+    for (auto& [id, handlers] : m_requests) {
+        if (
+            m_scheduler.isTracked(id) &&
+            m_scheduler.getPriority(id) == RequestPriority::Speculative &&
+            handlers.m_request.IsOk()
+        ) {
+            requests.push_back(handlers.m_request);
+        }
+    }
+    for (auto& request : requests) {
+        if (!m_requests.contains(request.GetId())) continue;
+        if (m_scheduler.isStarted(request.GetId())) {
+            request.Cancel();
+            continue;
+        }
+        // requests that never started won't get 
+        // any events from wx, so finish them here
+        wxWebRequestEvent evt(
+            wxEVT_WEBREQUEST_STATE, request.GetId(),
+            wxWebRequest::State_Cancelled, request, wxWebResponse()
+        );
+        this->onWebRequestState(evt);
+    }
+}
+
+/**
+ * Published digests come as plain hex or 
+ * prefixed with the algorithm ("sha256:...")
+ */
+static std::string normalizeDigest(std::string const& digest) {
+    auto hex = digest;
+    if (hex.rfind("sha256:", 0) == 0) {
+        hex = hex.substr(7);
+    }
+    std::transform(hex.begin(), hex.end(), hex.begin(), [](unsigned char c) -> char {
+        return static_cast<char>(std::tolower(c));
+    });
+    return hex;
+}
+
+struct FileDownloadState {
+    PartialDownload m_part;
+    int m_status = 0;
+    bool m_stalled = false;
+    long long m_offset = 0;
+    long long m_received = 0;
+    std::string m_error;
+
+    FileDownloadState(ghc::filesystem::path const& dir, std::string const& url)
+      : m_part(dir, url) {}
+};
+
+void Manager::downloadFileStream(
+    std::string const& url,
+    std::string const& digest,
+    DownloadErrorFunc errorFunc,
+    DownloadProgressFunc progressFunc,
+    DownloadFileFinishFunc finishFunc,
+    int attemptsLeft
+) {
+    auto state = std::make_shared<FileDownloadState>(
+        this->getDownloadsDirectory(), url
+    );
+
+    auto mirrored = this->getMirrors().resolve(url) != url;
+    auto request = this->createRequest(url);
+    if (!request.IsOk()) {
+        if (!errorFunc) return;
+        return errorFunc("Unable to create web request");
+    }
+    // we write the body ourselves so that 
+    // it survives the request failing
+    request.SetStorage(wxWebRequest::Storage_None);
+    if (state->m_part.canResume()) {
+        request.SetHeader("Range", "bytes=" + std::to_string(state->m_part.getSize()) + "-");
+        request.SetHeader("If-Range", state->m_part.getValidator());
+    }
+    else if (
+        auto cached = this->getDownloadCache().find(url);
+        cached && (digest.empty() || cached->m_hash == digest)
+    ) {
+        if (cached->m_etag.size()) {
+            request.SetHeader("If-None-Match", cached->m_etag);
+        }
+        if (cached->m_lastModified.size()) {
+            request.SetHeader("If-Modified-Since", cached->m_lastModified);
+        }
+    }
+
+    auto retry = [this, url, digest, errorFunc, progressFunc, finishFunc, attemptsLeft](
+        std::string const& error
+    ) -> void {
+        if (attemptsLeft > 1) {
+            this->CallAfter([=]() -> void {
+                this->downloadFileStream(url, digest, errorFunc, progressFunc, finishFunc, attemptsLeft - 1);
+            });
+        } else if (errorFunc) {
+            errorFunc(error);
+        }
+    };
+
+    this->handleRequestData(
+        request,
+        [this, state, progressFunc](wxWebRequestEvent& evt) -> void {
+        if (state->m_error.size()) return;
+
+        if (!state->m_status) {
+            auto res = evt.GetRequest().GetResponse();
+            state->m_status = res.GetStatus();
+
+            if (state->m_status == 206) {
+                long long start, total;
+                if (
+                    !parseContentRange(res.GetHeader("Content-Range").ToStdString(), start, total) ||
+                    start != static_cast<long long>(state->m_part.getSize())
+                ) {
+                    state->m_error = "Server resumed download at the wrong offset";
+                    return;
+                }
+                state->m_offset = start;
+            }
+            else if (state->m_status != 200) {
+                // error page, not the file
+                return;
+            }
+            auto res2 = state->m_part.begin(
+                state->m_status == 206,
+                res.GetHeader("ETag").ToStdString(),
+                res.GetHeader("Last-Modified").ToStdString()
+            );
+            if (!res2) {
+                state->m_error = res2.error();
+                return;
+            }
+        }
+        if (state->m_status != 200 && state->m_status != 206) return;
+
+        auto res = state->m_part.write(evt.GetDataBuffer(), evt.GetDataSize());
+        if (!res) {
+            state->m_error = res.error();
+            return;
+        }
+        state->m_received += evt.GetDataSize();
+
+        if (!progressFunc) return;
+        auto text = this->getProgressText(evt.GetRequest());
+        auto expected = evt.GetRequest().GetBytesExpectedToReceive();
+        if (expected <= 0) {
+            return progressFunc(text, 0);
+        }
+        progressFunc(
+            text,
+            static_cast<int>(
+                static_cast<double>(state->m_offset + state->m_received) /
+                (state->m_offset + expected) * 100.0
+            )
+        );
+    });
+
+    this->handleRequestState(
+        request,
+        [this, url, digest, state, mirrored, errorFunc, progressFunc, finishFunc, retry](wxWebRequestEvent& evt) -> void {
+        switch (evt.GetState()) {
+            case wxWebRequest::State_Completed: {
+                auto closed = state->m_part.close();
+                if (state->m_error.size() || !closed) {
+                    // the stored data can't be trusted anymore
+                    state->m_part.discard();
+                    return retry(state->m_error.size() ? state->m_error : closed.error());
+                }
+                auto res = evt.GetResponse();
+                if (!res.IsOk()) {
+                    if (!errorFunc) return;
+                    return errorFunc("Web request returned not OK");
+                }
+                if (res.GetStatus() == 304) {
+                    if (this->getDownloadCache().revalidated(url)) {
+                        return this->finishFromCache(url, digest, errorFunc, progressFunc, finishFunc);
+                    }
+                    return retry("Cached file is missing");
+                }
+                if (res.GetStatus() == 416) {
+                    // what we have doesn't match the 
+                    // file anymore, start over
+                    state->m_part.discard();
+                    return retry("Web request returned 416");
+                }
+                if (res.GetStatus() != 200 && res.GetStatus() != 206) {
+                    // another mirror may do better
+                    if (res.GetStatus() >= 500 || mirrored) {
+                        return retry(statusError(res.GetStatus()));
+                    }
+                    if (!errorFunc) return;
+                    return errorFunc(statusError(res.GetStatus()));
+                }
+                this->finishDownload(state->m_part, digest, errorFunc, finishFunc);
+            } break;
+
+            case wxWebRequest::State_Active: {
+                if (progressFunc && !state->m_received) {
+                    progressFunc("Beginning download", 0);
+                }
+            } break;
+
+            case wxWebRequest::State_Idle: {
+                if (progressFunc) progressFunc("Waiting", 0);
+            } break;
+
+            case wxWebRequest::State_Unauthorized: {
+                state->m_part.close();
+                if (errorFunc) errorFunc("Unauthorized to do web request");
+            } break;
+
+            case wxWebRequest::State_Failed: {
+                // keep what we got so the next 
+                // attempt can continue from there
+                state->m_part.close();
+                if (state->m_error.size()) {
+                    state->m_part.discard();
+                }
+                retry("Web request failed");
+            } break;
+
+            case wxWebRequest::State_Cancelled: {
+                state->m_part.close();
+                if (state->m_stalled) {
+                    return retry("Download stalled");
+                }
+                if (errorFunc) errorFunc("Web request cancelled");
+            } break;
+        }
+    });
+
+    this->handleRequestStall(request, [state, request]() mutable -> void {
+        state->m_stalled = true;
+        request.Cancel();
+    });
+
+    this->startRequest(request, RequestPriority::Bulk);
+}
+
+struct SegmentedDownload {
+    PartialDownload m_part;
+    /**
+     * Where the HEAD request went. Every segment 
+     * comes from there, since the validators of 
+     * other mirrors may not match
+     */
+    std::string m_source;
+    DownloadErrorFunc m_errorFunc;
+    DownloadProgressFunc m_progressFunc;
+    DownloadFileFinishFunc m_finishFunc;
+    std::string m_digest;
+    std::unordered_map<size_t, wxWebRequest> m_requests;
+    /**
+     * Combined telemetry of all segments, recorded 
+     * through this once the download is over
+     */
+    DownloadTelemetry m_telemetry;
+    DownloadTelemetryFunc m_telemetryFunc;
+    /**
+     * Downloads the file in one piece instead
+     */
+    std::function<void()> m_fallbackFunc;
+    bool m_failed = false;
+
+    SegmentedDownload(ghc::filesystem::path const& dir, std::string const& url)
+      : m_part(dir, url) {}
+
+    void finishTelemetry(int status, bool failed) {
+        if (m_telemetry.isDone()) return;
+        m_telemetry.finish(status, failed);
+        if (m_telemetryFunc) m_telemetryFunc(m_telemetry);
+    }
+
+    void cancel() {
+        m_failed = true;
+        for (auto& [_, req] : m_requests) {
+            req.Cancel();
+        }
+        m_requests.clear();
+    }
+
+    void fail(std::string const& error) {
+        if (m_failed) return;
+        this->cancel();
+        m_part.close();
+        this->finishTelemetry(0, true);
+        if (m_errorFunc) m_errorFunc(error);
+    }
+
+    void fallback() {
+        if (m_failed) return;
+        this->cancel();
+        m_part.discard();
+        this->finishTelemetry(0, true);
+        if (m_fallbackFunc) m_fallbackFunc();
+    }
+};
+
+void Manager::downloadFile(
+    std::string const& url,
+    DownloadErrorFunc errorFunc,
+    DownloadProgressFunc progressFunc,
+    DownloadFileFinishFunc finishFunc,
+    size_t segments,
+    std::string const& digest
+) {
+    auto expected = normalizeDigest(digest);
+    if (auto cached = this->getDownloadCache().find(url)) {
+        // the cache is content addressed, so a 
+        // cached file with another hash is stale
+        if (
+            (expected.empty() || cached->m_hash == expected) &&
+            this->getDownloadCache().get(url)
+        ) {
+            return this->finishFromCache(url, expected, errorFunc, progressFunc, finishFunc);
+        }
+    }
+
+    if (segments < 2) {
+        return this->downloadFileStream(
+            url, expected, errorFunc, progressFunc, finishFunc, DOWNLOAD_ATTEMPTS
+        );
+    }
+
+    // ask for the size of the file & whether 
+    // the server supports range requests first
+    auto source = this->getMirrors().resolve(url);
+    auto request = this->createRequest(source, false);
+    if (!request.IsOk()) {
+        if (!errorFunc) return;
+        return errorFunc("Unable to create web request");
+    }
+    request.SetMethod("HEAD");
+
+    if (progressFunc) progressFunc("Connecting", 0);
+
+    this->handleRequestState(
+        request,
+        [this, url, source, expected, errorFunc, progressFunc, finishFunc, segments](wxWebRequestEvent& evt) -> void {
+        auto fallback = [&]() -> void {
+            this->downloadFileStream(
+                url, expected, errorFunc, progressFunc, finishFunc, DOWNLOAD_ATTEMPTS
+            );
+        };
+        switch (evt.GetState()) {
+            case wxWebRequest::State_Completed: {
+                auto res = evt.GetResponse();
+                if (!res.IsOk() || res.GetStatus() != 200) {
+                    return fallback();
+                }
+                auto cached = this->getDownloadCache().find(url);
+                if (
+                    cached &&
+                    (expected.empty() || cached->m_hash == expected) && (
+                        (cached->m_etag.size() && cached->m_etag == res.GetHeader("ETag")) ||
+                        (cached->m_lastModified.size() && cached->m_lastModified == res.GetHeader("Last-Modified"))
+                    ) &&
+                    this->getDownloadCache().revalidated(url)
+                ) {
+                    return this->finishFromCache(url, expected, errorFunc, progressFunc, finishFunc);
+                }
+
+                auto total = res.GetContentLength();
+                if (
+                    !res.GetHeader("Accept-Ranges").Lower().Contains("bytes") ||
+                    total < static_cast<wxFileOffset>(segments * MIN_SEGMENT_SIZE)
+                ) {
+                    return fallback();
+                }
+                auto download = std::make_shared<SegmentedDownload>(
+                    this->getDownloadsDirectory(), url
+                );
+                download->m_errorFunc = errorFunc;
+                download->m_progressFunc = progressFunc;
+                download->m_finishFunc = finishFunc;
+                download->m_digest = expected;
+                download->m_source = source;
+                download->m_telemetry.start(source);
+                download->m_telemetry.dispatched();
+                download->m_telemetryFunc = [this](DownloadTelemetry const& telemetry) -> void {
+                    this->recordTelemetry(telemetry);
+                };
+                download->m_fallbackFunc = [this, url, expected, errorFunc, progressFunc, finishFunc]() -> void {
+                    // the cancelled segments still have 
+                    // events to deliver, so start afresh 
+                    // once they're out of the way
+                    this->CallAfter([=]() -> void {
+                        this->downloadFileStream(
+                            url, expected, errorFunc, progressFunc, finishFunc, DOWNLOAD_ATTEMPTS
+                        );
+                    });
+                };
+
+                auto begin = download->m_part.beginSegmented(
+                    static_cast<size_t>(total),
+                    segments,
+                    res.GetHeader("ETag").ToStdString(),
+                    res.GetHeader("Last-Modified").ToStdString()
+                );
+                if (!begin) {
+                    download->m_part.discard();
+                    return fallback();
+                }
+                auto& parts = download->m_part.getSegments();
+                for (size_t i = 0; i < parts.size(); i++) {
+                    // a segment that couldn't be started has 
+                    // already reported the error & cancelled 
+                    // the others
+                    if (download->m_failed) return;
+                    if (!parts[i].isDone()) {
+                        this->downloadFileSegment(download, i, DOWNLOAD_ATTEMPTS);
+                    }
+                }
+                if (download->m_failed) return;
+                if (download->m_requests.empty()) {
+                    if (download->m_part.getSegmentedProgress() != parts.back().m_end) {
+                        return download->fail("Unable to start the download");
+                    }
+                    // everything was already downloaded last time
+                    download->m_part.close();
+                    download->finishTelemetry(206, false);
+                    this->finishDownload(download->m_part, expected, errorFunc, finishFunc);
+                }
+            } break;
+
+            case wxWebRequest::State_Unauthorized:
+            case wxWebRequest::State_Failed:
+            case wxWebRequest::State_Cancelled: {
+                fallback();
+            } break;
+
+            default: break;
+        }
+    });
+
+    this->startRequest(request, RequestPriority::Interactive);
+}
+
+void Manager::downloadFileSegment(
+    std::shared_ptr<SegmentedDownload> download,
+    size_t index,
+    int attemptsLeft
+) {
+    auto& seg = download->m_part.getSegments().at(index);
+
+    auto request = this->createRequest(download->m_source, false);
+    if (!request.IsOk()) {
+        return download->fail("Unable to create web request");
+    }
+    request.SetStorage(wxWebRequest::Storage_None);
+    request.SetHeader(
+        "Range",
+        "bytes=" + std::to_string(seg.getPosition()) + "-" + std::to_string(seg.m_end - 1)
+    );
+    if (download->m_part.getValidator().size()) {
+        request.SetHeader("If-Range", download->m_part.getValidator());
+    }
+    download->m_requests[index] = request;
+
+    auto checked = std::make_shared<bool>(false);
+    auto stalled = std::make_shared<bool>(false);
+
+    this->handleRequestData(
+        request,
+        [download, index, checked](wxWebRequestEvent& evt) -> void {
+        if (download->m_failed) return;
+
+        if (!*checked) {
+            *checked = true;
+            // a 200 means the server ignored the range or 
+            // the file changed since the HEAD request; 
+            // either way the segments can't be joined, 
+            // but a plain download still works
+            auto res = evt.GetRequest().GetResponse();
+            long long start, total;
+            if (
+                res.GetStatus() != 206 ||
+                !parseContentRange(res.GetHeader("Content-Range").ToStdString(), start, total) ||
+                start != static_cast<long long>(download->m_part.getSegments().at(index).getPosition())
+            ) {
+                return download->fallback();
+            }
+        }
+
+        auto res = download->m_part.writeSegment(index, evt.GetDataBuffer(), evt.GetDataSize());
+        if (!res) {
+            return download->fail(res.error());
+        }
+
+        auto& parts = download->m_part.getSegments();
+        download->m_telemetry.received(
+            download->m_part.getSegmentedProgress(),
+            parts.back().m_end
+        );
+        if (download->m_progressFunc) {
+            download->m_progressFunc(
+                "Downloading " + download->m_telemetry.describe(),
+                static_cast<int>(
+                    static_cast<double>(download->m_part.getSegmentedProgress()) /
+                    parts.back().m_end * 100.0
+                )
+            );
+        }
+    });
+
+    this->handleRequestState(
+        request,
+        [this, download, index, attemptsLeft, stalled](wxWebRequestEvent& evt) -> void {
+        if (download->m_failed) return;
+
+        switch (evt.GetState()) {
+            case wxWebRequest::State_Cancelled: {
+                if (!*stalled) {
+                    download->fail("Web request cancelled");
+                    break;
+                }
+                // stalled, try again from where it stopped
+            } [[fallthrough]];
+
+            case wxWebRequest::State_Completed:
+            case wxWebRequest::State_Failed: {
+                download->m_requests.erase(index);
+                download->m_part.saveProgress();
+
+                if (!download->m_part.getSegments().at(index).isDone()) {
+                    if (attemptsLeft > 1) {
+                        return this->downloadFileSegment(download, index, attemptsLeft - 1);
+                    }
+                    // the mirror gave up on us; a plain download 
+                    // starts over on whichever one ranks best now
+                    if (download->m_source != download->m_part.getURL()) {
+                        return download->fallback();
+                    }
+                    auto res = evt.GetResponse();
+                    if (res.IsOk() && res.GetStatus() >= 400) {
+                        return download->fail(statusError(res.GetStatus()));
+                    }
+                    return download->fail(*stalled ? "Download stalled" : "Web request failed");
+                }
+
+                if (download->m_requests.empty()) {
+                    auto res = download->m_part.close();
+                    if (!res) {
+                        return download->fail(res.error());
+                    }
+                    download->finishTelemetry(206, false);
+                    this->finishDownload(
+                        download->m_part, download->m_digest,
+                        download->m_errorFunc, download->m_finishFunc
+                    );
+                }
+            } break;
+
+            case wxWebRequest::State_Unauthorized: {
+                download->fail("Unauthorized to do web request");
+            } break;
 
-    // nothing we rly need to do
-    return Ok();
+            default: break;
+        }
+    });
 
-    #endif
-}
+    this->handleRequestStall(request, [stalled, request]() mutable -> void {
+        *stalled = true;
+        request.Cancel();
+    });
 
+    this->startRequest(request, RequestPriority::Bulk);
+}
 
-InstallerMode Manager::getInstallerMode() const {
-    return m_mode;
+void Manager::finishDownload(
+    PartialDownload& part,
+    std::string const& digest,
+    DownloadErrorFunc errorFunc,
+    DownloadFileFinishFunc finishFunc
+) {
+    auto hash = part.getHash();
+    if (hash && digest.size() && hash.value() != digest) {
+        part.discard();
+        if (errorFunc) errorFunc("Downloaded file doesn't match its published checksum");
+        return;
+    }
+    if (!hash && digest.size()) {
+        part.discard();
+        if (errorFunc) errorFunc("Unable to verify downloaded file: " + hash.error());
+        return;
+    }
+    auto cached = this->getDownloadCache().store(
+        part.getURL(), part.getETag(), part.getLastModified(), part.getPath(),
+        hash ? hash.value() : ""
+    );
+    if (cached) {
+        if (finishFunc) finishFunc(cached.value());
+    } else {
+        // not being able to cache the file 
+        // shouldn't stop the installation
+        if (finishFunc) finishFunc(part.getPath());
+    }
+    part.discard();
 }
 
-ghc::filesystem::path const& Manager::getLoaderUpdatePath() const {
-    return m_loaderUpdatePath;
+void Manager::finishFromCache(
+    std::string const& url,
+    std::string const& digest,
+    DownloadErrorFunc errorFunc,
+    DownloadProgressFunc progressFunc,
+    DownloadFileFinishFunc finishFunc
+) {
+    if (progressFunc) progressFunc("Using cached file", 100);
+    auto entry = this->getDownloadCache().find(url);
+    if (!entry) return;
+    if (digest.size() && entry->m_hash != digest) {
+        // the server says our copy is current, 
+        // so the file it serves is wrong too
+        this->CallAfter([errorFunc]() -> void {
+            if (errorFunc) errorFunc("Downloaded file doesn't match its published checksum");
+        });
+        return;
+    }
+    auto file = this->getDownloadCacheDirectory() / entry->m_hash;
+    // keep the callback asynchronous like 
+    // it is for actual downloads
+    this->CallAfter([file, finishFunc]() -> void {
+        if (finishFunc) finishFunc(file);
+    });
 }
 
+struct StreamDownloadState {
+    /**
+     * The body is hashed on its way into the pipe; 
+     * nothing of it is written to disk
+     */
+    SHA256 m_hash;
+    std::shared_ptr<PipeInputStream> m_pipe;
+    wxWebRequest m_request;
+    DownloadErrorFunc m_errorFunc;
+    CloneFinishFunc m_finishFunc;
+    std::string m_digest;
+    int m_status = 0;
+    long long m_received = 0;
+    bool m_requestDone = false;
+    bool m_consumerDone = false;
+    bool m_cancelled = false;
+    bool m_finished = false;
+    std::string m_requestError;
+    std::string m_consumerError;
+
+    StreamDownloadState() : m_pipe(std::make_shared<PipeInputStream>()) {}
+
+    void requestDone(std::string const& error) {
+        m_requestDone = true;
+        if (error.size() && !m_cancelled) {
+            m_requestError = error;
+        }
+        if (m_requestError.size()) {
+            m_pipe->fail();
+        } else {
+            m_pipe->close();
+        }
+        this->tryFinish();
+    }
+
+    void consumerDone(std::string const& error) {
+        m_consumerDone = true;
+        m_consumerError = error;
+        if (error.size() && !m_requestDone) {
+            // no point in downloading the rest
+            m_cancelled = true;
+            m_request.Cancel();
+        }
+        this->tryFinish();
+    }
+
+    void tryFinish() {
+        if (!m_requestDone || !m_consumerDone || m_finished) return;
+        m_finished = true;
+
+        auto error = m_requestError.size() ? m_requestError : m_consumerError;
+        if (error.size()) {
+            if (m_errorFunc) m_errorFunc(error);
+            return;
+        }
+        if (m_digest.size() && m_hash.finish() != m_digest) {
+            if (m_errorFunc) m_errorFunc("Downloaded file doesn't match its published checksum");
+            return;
+        }
+        if (m_finishFunc) m_finishFunc();
+    }
+};
 
-void Manager::webRequest(
+void Manager::streamFile(
     std::string const& url,
-    bool downloadFile,
+    std::string const& digest,
     DownloadErrorFunc errorFunc,
     DownloadProgressFunc progressFunc,
-    DownloadFinishFunc finishFunc
+    DownloadStreamFunc consumer,
+    CloneFinishFunc finishFunc
 ) {
-    auto request = wxWebSession::GetDefault().CreateRequest(this, url);
+    auto state = std::make_shared<StreamDownloadState>();
+    state->m_errorFunc = errorFunc;
+    state->m_finishFunc = finishFunc;
+    state->m_digest = normalizeDigest(digest);
+
+    auto request = this->createRequest(url);
     if (!request.IsOk()) {
         if (!errorFunc) return;
         return errorFunc("Unable to create web request");
     }
-    if (downloadFile) {
-        request.SetStorage(wxWebRequest::Storage_File);
-    }
-    this->Bind(
-        wxEVT_WEBREQUEST_STATE,
-        [errorFunc, progressFunc, finishFunc](wxWebRequestEvent& evt) -> void {
+    request.SetStorage(wxWebRequest::Storage_None);
+    state->m_request = request;
+
+    this->handleRequestData(
+        request,
+        [this, state, progressFunc](wxWebRequestEvent& evt) -> void {
+        if (!state->m_status) {
+            state->m_status = evt.GetRequest().GetResponse().GetStatus();
+        }
+        if (state->m_status != 200) return;
+
+        state->m_hash.update(evt.GetDataBuffer(), evt.GetDataSize());
+        state->m_pipe->write(evt.GetDataBuffer(), evt.GetDataSize());
+        state->m_received += evt.GetDataSize();
+
+        if (!progressFunc) return;
+        auto text = this->getProgressText(evt.GetRequest());
+        auto expected = evt.GetRequest().GetBytesExpectedToReceive();
+        if (expected <= 0) {
+            return progressFunc(text, 0);
+        }
+        progressFunc(
+            text,
+            static_cast<int>(static_cast<double>(state->m_received) / expected * 100.0)
+        );
+    });
+
+    this->handleRequestState(
+        request,
+        [state, progressFunc](wxWebRequestEvent& evt) -> void {
         switch (evt.GetState()) {
             case wxWebRequest::State_Completed: {
                 auto res = evt.GetResponse();
                 if (!res.IsOk()) {
-                    if (!errorFunc) return;
-                    return errorFunc("Web request returned not OK");
+                    return state->requestDone("Web request returned not OK");
                 }
                 if (res.GetStatus() != 200) {
-                    if (!errorFunc) return;
-                    return errorFunc("Web request returned " + std::to_string(res.GetStatus()));
+                    return state->requestDone(statusError(res.GetStatus()));
                 }
-                if (finishFunc) finishFunc(res);
+                state->requestDone("");
             } break;
 
             case wxWebRequest::State_Active: {
-                if (!progressFunc) return;
-                if (evt.GetRequest().GetBytesExpectedToReceive() == -1) {
-                    return progressFunc("Beginning download", 0);
+                if (progressFunc && !state->m_received) {
+                    progressFunc("Beginning download", 0);
                 }
-                progressFunc(
-                    "Downloading",
-                    static_cast<int>(
-                        static_cast<double>(evt.GetRequest().GetBytesReceived()) /
-                        evt.GetRequest().GetBytesExpectedToReceive() * 100.0
-                    )
-                );
             } break;
 
             case wxWebRequest::State_Idle: {
@@ -140,105 +1417,164 @@ void Manager::webRequest(
             } break;
 
             case wxWebRequest::State_Unauthorized: {
-                if (errorFunc) errorFunc("Unauthorized to do web request");
+                state->requestDone("Unauthorized to do web request");
             } break;
 
             case wxWebRequest::State_Failed: {
-                if (errorFunc) errorFunc("Web request failed");
+                state->requestDone("Web request failed");
             } break;
 
             case wxWebRequest::State_Cancelled: {
-                if (errorFunc) errorFunc("Web request cancelled");
+                state->requestDone("Web request cancelled");
             } break;
         }
     });
-    request.Start();
+
+    // the consumer works on its own thread while 
+    // the main thread keeps receiving data
+    std::thread t([this, state, consumer]() -> void {
+        auto res = consumer(*state->m_pipe);
+        auto error = res ? std::string() : res.error();
+        wxQueueEvent(this, new CallOnMainEvent(
+            [state, error]() -> void {
+                state->consumerDone(error);
+            },
+            CALL_ON_MAIN,
+            wxID_ANY
+        ));
+    });
+    t.detach();
+
+    this->startRequest(request, RequestPriority::Bulk);
 }
 
 Result<> Manager::unzipTo(
     ghc::filesystem::path const& zipLocation,
-    ghc::filesystem::path const& targetLocation
+    ghc::filesystem::path const& targetLocation,
+    ExtractIndex* index,
+    ghc::filesystem::path const& current
 ) {
-    wxFileInputStream fis(zipLocation.wstring());
-    if (!fis.IsOk()) {
-        return Err("Unable to open zip");
-    }
-    wxZipInputStream zip(fis);
-    if (!zip.IsOk()) {
-        return Err("Unable to read zip");
-    }
-    std::unique_ptr<wxZipEntry> entry;
-    while (entry.reset(zip.GetNextEntry()), entry) {
-        auto path = targetLocation / entry->GetName().ToStdWstring();
-        wxFileName fn;
-
-        if (entry->IsDir()) {
-            fn.AssignDir(path.wstring());
-        } else {
-            fn.Assign(path.wstring());
-        }
-
-        if (!wxDirExists(fn.GetPath())) {
-            wxFileName::Mkdir(fn.GetPath(), entry->GetMode(), wxPATH_MKDIR_FULL);
-        }
-
-        if (entry->IsDir()) continue;
-
-        if (!zip.CanRead()) {
-            return Err(
-                "Unable to read the zip entry \"" +
-                entry->GetName().ToStdString() + "\""
-            );
-        }
-
-        wxFileOutputStream out(path.wstring());
-
-        if (!out.IsOk()) {
-            return Err("Unable to create file \"" + path.string() + "\"");
-        }
+    DiskTarget disk;
+    return extractArchive(zipLocation, disk, targetLocation, index, current);
+}
 
-        zip.Read(out);
-    }
-    return Ok();
+Result<> Manager::unzipFrom(
+    wxInputStream& stream,
+    ghc::filesystem::path const& targetLocation,
+    ExtractIndex* index,
+    ghc::filesystem::path const& current
+) {
+    DiskTarget disk;
+    return extractStream(stream, disk, targetLocation, index, current);
 }
 
-void Manager::downloadCLI(
+void Manager::findCLIAsset(
     DownloadErrorFunc errorFunc,
     DownloadProgressFunc progressFunc,
-    DownloadFinishFunc finishFunc
+    std::function<void(std::string const& url, std::string const& digest)> foundFunc
 ) {
-    this->webRequest(
+    this->fetchMetadata(
         "https://api.github.com/repos/geode-sdk/cli/releases/latest",
-        false,
         errorFunc,
-        nullptr,
-        [this, errorFunc, progressFunc, finishFunc](wxWebResponse const& res) -> void {
-            try {
-                auto json = nlohmann::json::parse(res.AsString());
-
-                auto tagName = json["tag_name"].get<std::string>();
-                if (progressFunc) progressFunc("Downloading version " + tagName, 0);
-
-                for (auto& asset : json["assets"]) {
-                    auto name = asset["name"].get<std::string>();
-                    if (name.find(PLATFORM_ASSET_IDENTIFIER) != std::string::npos) {
-                        return this->webRequest(
-                            asset["browser_download_url"].get<std::string>(),
-                            true,
-                            errorFunc,
-                            progressFunc,
-                            finishFunc
-                        );
-                    }
-                }
+        [errorFunc, progressFunc, foundFunc](std::string const& body) -> void {
+            auto release = ReleaseInfo::parse(body);
+            if (!release) {
+                if (errorFunc) errorFunc(release.error());
+                return;
+            }
+            auto info = release.value();
+            if (progressFunc) progressFunc("Downloading version " + info.m_tagName, 0);
+
+            // without zstd only the zip can be extracted, 
+            // so the suffix has to be given either way
+            #ifdef GEODE_HAS_ZSTD
+            // smaller & faster to extract than the zip
+            auto asset = info.findAsset(PLATFORM_ASSET_IDENTIFIER, ".tar.zst");
+            if (!asset) {
+                asset = info.findAsset(PLATFORM_ASSET_IDENTIFIER, ".zip");
+            }
+            #else
+            auto asset = info.findAsset(PLATFORM_ASSET_IDENTIFIER, ".zip");
+            #endif
+            if (!asset || asset->m_url.empty()) {
                 if (errorFunc) {
                     errorFunc("No release asset for " PLATFORM_NAME " found");
                 }
-            } catch(std::exception& e) {
-                if (errorFunc) {
-                    errorFunc("Unable to parse JSON: " + std::string(e.what()));
-                }
+                return;
             }
+            // GitHub publishes a SHA-256 
+            // digest for every asset
+            foundFunc(asset->m_url, asset->m_digest);
+        }
+    );
+}
+
+/**
+ * Summary of the file writes since the 
+ * stats were last reset, for the stage log
+ */
+static std::string describeWrites() {
+    auto stats = FileWriter::getStats();
+    if (!stats.m_files) return "";
+    std::stringstream ss;
+    ss << stats.m_files << " files, "
+       << stats.m_writes << " writes ("
+       << std::fixed << std::setprecision(2)
+       << static_cast<double>(stats.m_writes) / stats.m_files << " per file), "
+       << stats.m_preallocations << " preallocated, "
+       << static_cast<double>(stats.getSyscalls()) / stats.m_files << " syscalls per file";
+    return ss.str();
+}
+
+void Manager::downloadAndInstallCLI(
+    DownloadErrorFunc errorFunc,
+    DownloadErrorFunc installErrorFunc,
+    DownloadProgressFunc progressFunc,
+    CloneFinishFunc finishFunc
+) {
+    auto started = DownloadTelemetry::now();
+    this->findCLIAsset(
+        errorFunc,
+        progressFunc,
+        [this, errorFunc, installErrorFunc, progressFunc, finishFunc, started](
+            std::string const& url,
+            std::string const& digest
+        ) -> void {
+            this->recordStage("cli-metadata", started);
+            auto downloadStarted = DownloadTelemetry::now();
+            // extract somewhere else first, the files are 
+            // only moved into place once the archive has 
+            // been checked against its digest
+            auto staging = this->getCLIStagingDirectory();
+            auto index = &this->getExtractIndex();
+            this->streamFile(
+                url, digest,
+                [errorFunc, staging](std::string const& error) -> void {
+                    std::error_code ec;
+                    ghc::filesystem::remove_all(staging, ec);
+                    if (errorFunc) errorFunc(error);
+                },
+                progressFunc,
+                [this, staging, index](wxInputStream& stream) -> Result<> {
+                    std::error_code ec;
+                    ghc::filesystem::remove_all(staging, ec);
+                    FileWriter::resetStats();
+                    // files that haven't changed since the 
+                    // installed version are linked over
+                    return this->unzipFrom(stream, staging, index, m_binDirectory);
+                },
+                [this, installErrorFunc, finishFunc, staging, downloadStarted]() -> void {
+                    this->recordStage("cli-download-extract", downloadStarted, 0, describeWrites());
+                    auto installStarted = DownloadTelemetry::now();
+                    auto res = this->installStagedCLI(staging);
+                    if (!res) {
+                        if (installErrorFunc) installErrorFunc(res.error());
+                        return;
+                    }
+                    this->recordStage("cli-install", installStarted);
+                    if (finishFunc) finishFunc();
+                }
+            );
         }
     );
 }
@@ -248,24 +1584,14 @@ void Manager::checkForUpdates(
     DownloadErrorFunc errorFunc,
     UpdateCheckFinishFunc finishFunc
 ) {
-
-    std::string url = "https://raw.githubusercontent.com/geode-sdk/suite/main/versions.json";
-
-    if (installation.m_branch == DevBranch::Nightly) {
-        url = "https://raw.githubusercontent.com/geode-sdk/suite/nightly/versions.json";
-    }
-
-    this->webRequest(
-        url,
-        false,
+    this->fetchJson(
+        getVersionsURL(installation.m_branch),
         errorFunc,
-        nullptr,
         [this, errorFunc, finishFunc, installation](
-            wxWebResponse const& res
+            nlohmann::json const& json
         ) -> void {
             try {
-                auto json = nlohmann::json::parse(res.AsString());
-                auto availableVersion = VersionInfo(json["loader"].get<std::string>());
+                auto availableVersion = VersionInfo(json.at("loader").get<std::string>());
                 finishFunc(installation.m_loaderVersion, availableVersion);
             } catch(std::exception& e) {
                 if (errorFunc) {
@@ -280,19 +1606,14 @@ void Manager::checkCLIForUpdates(
     DownloadErrorFunc errorFunc,
     UpdateCheckFinishFunc finishFunc
 ) {
-    std::string url = "https://raw.githubusercontent.com/geode-sdk/suite/main/versions.json";
-
-    this->webRequest(
-        url,
-        false,
+    this->fetchJson(
+        getVersionsURL(DevBranch::Stable),
         errorFunc,
-        nullptr,
         [this, errorFunc, finishFunc](
-            wxWebResponse const& res
+            nlohmann::json const& json
         ) -> void {
             try {
-                auto json = nlohmann::json::parse(res.AsString());
-                auto availableVersion = VersionInfo(json["cli"].get<std::string>());
+                auto availableVersion = VersionInfo(json.at("cli").get<std::string>());
                 finishFunc(this->m_CLIVersion, availableVersion);
             } catch(std::exception& e) {
                 if (errorFunc) {
@@ -308,6 +1629,176 @@ ghc::filesystem::path const& Manager::getDataDirectory() const {
     return m_dataDirectory;
 }
 
+ghc::filesystem::path Manager::getDownloadsDirectory() const {
+    return m_dataDirectory / DOWNLOADS_DIR;
+}
+
+ghc::filesystem::path Manager::getDownloadCacheDirectory() const {
+    return m_dataDirectory / DOWNLOAD_CACHE_DIR;
+}
+
+MetadataCache& Manager::getMetadataCache() {
+    if (!m_metadataCache) {
+        long long ttl = METADATA_TTL;
+        if (m_loadedConfigJson.contains("metadata-ttl")) {
+            ttl = m_loadedConfigJson["metadata-ttl"].get<long long>();
+        }
+        m_metadataCache = std::make_unique<MetadataCache>(
+            m_dataDirectory / METADATA_CACHE_JSON, ttl
+        );
+        m_metadataCache->load();
+    }
+    return *m_metadataCache;
+}
+
+MirrorList& Manager::getMirrors() {
+    if (!m_mirrors) {
+        std::vector<std::string> bases;
+        if (m_loadedConfigJson.contains("mirrors")) {
+            bases = m_loadedConfigJson["mirrors"].get<std::vector<std::string>>();
+        }
+        m_mirrors = std::make_unique<MirrorList>(bases);
+        if (m_fixtureServer) {
+            m_mirrors->useOnly(m_fixtureServer->getURL());
+            bases.clear();
+        }
+        if (bases.size()) {
+            this->CallAfter([this]() -> void {
+                this->probeMirrors();
+            });
+        }
+    }
+    return *m_mirrors;
+}
+
+void Manager::probeMirrors() {
+    for (auto& mirror : this->getMirrors().getMirrors()) {
+        // the result is picked up by the 
+        // mirror list like any other request
+        auto request = this->createRequest(
+            MirrorList::rewrite(mirror, MIRROR_PROBE_URL), false
+        );
+        if (!request.IsOk()) continue;
+        request.SetMethod("HEAD");
+        this->startRequest(request, RequestPriority::Interactive);
+    }
+}
+
+Result<> Manager::startFixtureServer(
+    ghc::filesystem::path const& directory,
+    FixtureServerOptions const& options
+) {
+    auto server = std::make_unique<FixtureServer>(directory, options);
+    auto res = server->start();
+    if (!res) return res;
+    // this may run before the config is loaded, 
+    // in which case getMirrors adds it later
+    if (m_mirrors) {
+        m_mirrors->useOnly(server->getURL());
+    }
+    m_fixtureServer = std::move(server);
+    return Ok();
+}
+
+FixtureServer* Manager::getFixtureServer() const {
+    return m_fixtureServer.get();
+}
+
+void Manager::runFixtureBenchmark(
+    ghc::filesystem::path const& directory,
+    DownloadErrorFunc errorFunc,
+    CloneFinishFunc finishFunc
+) {
+    if (!m_fixtureServer) {
+        return errorFunc("The fixture server isn't running");
+    }
+    std::error_code ec;
+    ghc::filesystem::remove_all(directory, ec);
+    m_dataDirectory = directory / "data";
+    m_binDirectory = directory / "bin";
+    if (!ghc::filesystem::create_directories(m_dataDirectory, ec)) {
+        return errorFunc("Unable to create directory " + m_dataDirectory.string());
+    }
+    m_stageTimings.clear();
+
+    auto started = DownloadTelemetry::now();
+    this->fetchJson(
+        getVersionsURL(DevBranch::Stable),
+        errorFunc,
+        [this, errorFunc, finishFunc, started](nlohmann::json const&) -> void {
+            this->recordStage("versions", started);
+            this->downloadAndInstallCLI(
+                errorFunc,
+                errorFunc,
+                nullptr,
+                [this, errorFunc, finishFunc]() -> void {
+                    this->installGeodeUtilsLib(
+                        false, DevBranch::Stable, errorFunc, nullptr, finishFunc
+                    );
+                }
+            );
+        }
+    );
+}
+
+void Manager::recordStage(
+    std::string const& name,
+    long long started,
+    size_t bytes,
+    std::string const& details
+) {
+    StageTiming timing;
+    timing.m_name = name;
+    timing.m_duration = DownloadTelemetry::now() - started;
+    timing.m_bytes = bytes;
+    timing.m_details = details;
+    m_stageTimings.push_back(timing);
+
+    if (!m_fixtureServer || m_dataDirectory.empty()) return;
+    std::ofstream ofs(m_dataDirectory / STAGE_TIMINGS_LOG, std::ios::app);
+    ofs << timing.m_name << "\t" << timing.m_duration << " ms";
+    if (timing.m_bytes) {
+        ofs << "\t" << DownloadTelemetry::formatSize(static_cast<double>(timing.m_bytes));
+        if (timing.m_duration > 0) {
+            ofs << "\t" << DownloadTelemetry::formatSize(
+                timing.m_bytes * 1000.0 / timing.m_duration
+            ) << "/s";
+        }
+    }
+    if (timing.m_details.size()) {
+        ofs << "\t" << timing.m_details;
+    }
+    ofs << "\n";
+}
+
+std::vector<StageTiming> const& Manager::getStageTimings() const {
+    return m_stageTimings;
+}
+
+ExtractIndex& Manager::getExtractIndex() {
+    if (!m_extractIndex) {
+        m_extractIndex = std::make_unique<ExtractIndex>(
+            m_dataDirectory / EXTRACT_INDEX_JSON
+        );
+        m_extractIndex->load();
+    }
+    return *m_extractIndex;
+}
+
+DownloadCache& Manager::getDownloadCache() {
+    if (!m_downloadCache) {
+        size_t size = DOWNLOAD_CACHE_SIZE;
+        if (m_loadedConfigJson.contains("download-cache-size")) {
+            size = m_loadedConfigJson["download-cache-size"].get<size_t>();
+        }
+        m_downloadCache = std::make_unique<DownloadCache>(
+            this->getDownloadCacheDirectory(), size * 1024 * 1024
+        );
+        m_downloadCache->load();
+    }
+    return *m_downloadCache;
+}
+
 ghc::filesystem::path Manager::getDefaultDataDirectory() const {
     #ifdef _WIN32
 
@@ -464,6 +1955,93 @@ void Manager::setCLIVersion(VersionInfo const& v) {
 
 Result<> Manager::installCLI(
     ghc::filesystem::path const& cliZipPath
+) {
+    auto staging = this->getCLIStagingDirectory();
+    std::error_code ec;
+    ghc::filesystem::remove_all(staging, ec);
+    if (!ghc::filesystem::create_directories(staging, ec)) {
+        return Err("Unable to create directory " + staging.string());
+    }
+    // files that are the same as the installed 
+    // ones are linked instead of extracted
+    auto& index = this->getExtractIndex();
+    auto res = this->unzipTo(cliZipPath, staging, &index, m_binDirectory);
+    if (!res) {
+        ghc::filesystem::remove_all(staging, ec);
+        return res;
+    }
+    return this->installStagedCLI(staging);
+}
+
+ghc::filesystem::path Manager::getCLIStagingDirectory() const {
+    return m_binDirectory.string() + CLI_STAGING_SUFFIX;
+}
+
+ghc::filesystem::path Manager::getCLIBackupDirectory() const {
+    return m_binDirectory.string() + CLI_BACKUP_SUFFIX;
+}
+
+Result<> Manager::replaceDirectory(
+    ghc::filesystem::path const& from,
+    ghc::filesystem::path const& to,
+    ghc::filesystem::path const& backup
+) {
+    auto& index = this->getExtractIndex();
+    std::error_code ec;
+    ghc::filesystem::remove_all(backup, ec);
+    ec.clear();
+    if (!ghc::filesystem::exists(to)) {
+        ghc::filesystem::rename(from, to, ec);
+        if (ec) return Err("Unable to move " + from.string() + ": " + ec.message());
+        index.move(from, to);
+        return Ok();
+    }
+    #ifdef __APPLE__
+    // swap both in one step, then move 
+    // the old one out of the way
+    if (__builtin_available(macOS 10.12, *)) {
+        if (renamex_np(from.c_str(), to.c_str(), RENAME_SWAP) == 0) {
+            index.move(to, backup);
+            index.move(from, to);
+            ghc::filesystem::rename(from, backup, ec);
+            return Ok();
+        }
+    }
+    #endif
+    ghc::filesystem::rename(to, backup, ec);
+    if (ec) return Err("Unable to move " + to.string() + ": " + ec.message());
+    ghc::filesystem::rename(from, to, ec);
+    if (ec) {
+        std::error_code ignored;
+        ghc::filesystem::rename(backup, to, ignored);
+        return Err("Unable to move " + from.string() + ": " + ec.message());
+    }
+    index.move(to, backup);
+    index.move(from, to);
+    return Ok();
+}
+
+Result<> Manager::rollbackCLI() {
+    auto backup = this->getCLIBackupDirectory();
+    if (!ghc::filesystem::is_directory(backup)) {
+        return Err("There is no previous version of the CLI to go back to");
+    }
+    // the current version becomes the backup, 
+    // so a rollback can be undone the same way
+    auto swap = this->getCLIStagingDirectory();
+    auto res = this->replaceDirectory(backup, m_binDirectory, swap);
+    if (!res) return res;
+    std::error_code ec;
+    ghc::filesystem::rename(swap, backup, ec);
+    if (!ec) {
+        this->getExtractIndex().move(swap, backup);
+    }
+    this->getExtractIndex().save();
+    return Ok();
+}
+
+Result<> Manager::installStagedCLI(
+    ghc::filesystem::path const& stagingDir
 ) {
     auto targetDir = m_binDirectory;
     if (
@@ -472,7 +2050,75 @@ Result<> Manager::installCLI(
     ) {
         return Err("Unable to create directory " + targetDir.string());
     }
-    return this->unzipTo(cliZipPath, targetDir);
+    auto& index = this->getExtractIndex();
+    std::error_code ec;
+
+    // anything in the bin directory that isn't 
+    // part of the CLI, like geodeutils, comes along. 
+    // these are copied rather than linked since 
+    // they're updated in place later on, and that 
+    // must not change the backup's copy
+    for (
+        auto it = ghc::filesystem::recursive_directory_iterator(targetDir, ec);
+        !ec && it != ghc::filesystem::recursive_directory_iterator();
+        it.increment(ec)
+    ) {
+        auto staged = stagingDir / ghc::filesystem::relative(it->path(), targetDir, ec);
+        if (ec || ghc::filesystem::exists(staged)) continue;
+        if (it->is_directory()) {
+            ghc::filesystem::create_directories(staged, ec);
+            continue;
+        }
+        ghc::filesystem::copy_file(it->path(), staged, ec);
+        if (ec) break;
+    }
+    if (ec) {
+        return Err("Unable to carry over files from " + targetDir.string() + ": " + ec.message());
+    }
+
+    // the whole new tree goes live with one 
+    // rename & the old one is kept for rollback
+    auto swapped = this->replaceDirectory(stagingDir, targetDir, this->getCLIBackupDirectory());
+    if (swapped) {
+        index.save();
+        return Ok();
+    }
+
+    // something in the bin directory is in use, so 
+    // copy the staged files over the installed ones 
+    // that differ instead
+    for (
+        auto it = ghc::filesystem::recursive_directory_iterator(stagingDir, ec);
+        !ec && it != ghc::filesystem::recursive_directory_iterator();
+        it.increment(ec)
+    ) {
+        auto target = targetDir / ghc::filesystem::relative(it->path(), stagingDir, ec);
+        if (ec) break;
+        if (it->is_directory()) {
+            ghc::filesystem::create_directories(target, ec);
+            if (ec) break;
+            continue;
+        }
+        // carried over or linked when extracting
+        if (ghc::filesystem::equivalent(it->path(), target, ec)) continue;
+        ec.clear();
+        auto size = static_cast<size_t>(it->file_size(ec));
+        if (ec) break;
+        auto crc = CRC32::hashFile(it->path());
+        if (index.isUnchanged(target, crc, size)) continue;
+        // the old file may be linked into the 
+        // backup, so don't write through it
+        ghc::filesystem::remove(target, ec);
+        ghc::filesystem::copy_file(it->path(), target, ec);
+        if (ec) break;
+        index.record(target, crc, size);
+    }
+    index.save();
+    if (ec) {
+        return Err("Unable to copy the CLI into " + targetDir.string() + ": " + ec.message());
+    }
+    ghc::filesystem::remove_all(stagingDir, ec);
+    return Ok();
 }
 
 Result<> Manager::addCLIToPath() {
@@ -507,11 +2153,7 @@ Result<> Manager::addCLIToPath() {
 }
 
 bool Manager::isGeodeUtilsInstalled() const {
-    #ifdef _WIN32
-    return ghc::filesystem::exists(m_binDirectory / "geodeutils.dll");
-    #else
-    return ghc::filesystem::exists(m_binDirectory / "libgeodeutils.dylib");
-    #endif
+    return ghc::filesystem::exists(m_binDirectory / GEODE_UTILS_LIB);
 }
 
 void* Manager::loadFunctionFromUtilsLib(const char* name) {
@@ -536,8 +2178,6 @@ Result<> Manager::installSuite(
         return Err("Geode CLI seems to not have been installed");
     }
 
-    this->Bind(CALL_ON_MAIN, &Manager::onSyncThreadCall, this);
-
     std::thread t([this, branch, errorFunc, progressFunc, finishFunc]() -> void {
         auto throwError = [errorFunc, this](std::string const& msg) -> void {
             wxQueueEvent(this, new CallOnMainEvent(
@@ -651,41 +2291,149 @@ void Manager::installGeodeUtilsLib(
     if (!update && this->isGeodeUtilsInstalled()) {
         return finishFunc();
     }
-    this->webRequest(
+    std::string url = 
     #ifdef _WIN32
     branch == DevBranch::Nightly ? 
         "https://github.com/geode-sdk/suite/raw/nightly/windows/geodeutils.dll" : 
-        "https://github.com/geode-sdk/suite/raw/main/windows/geodeutils.dll",
+        "https://github.com/geode-sdk/suite/raw/main/windows/geodeutils.dll";
     #elif defined(__APPLE__)
     branch == DevBranch::Nightly ? 
         "https://github.com/geode-sdk/suite/raw/nightly/macos/libgeodeutils.dylib" :
-        "https://github.com/geode-sdk/suite/raw/main/macos/libgeodeutils.dylib",
+        "https://github.com/geode-sdk/suite/raw/main/macos/libgeodeutils.dylib";
     #else
         #error "Define download URL for geodeutils"
     #endif
-        true,
-        errorFunc,
-        progressFunc,
-        [this, errorFunc, finishFunc](wxWebResponse const& res) -> void {
-            try {
-                if (
-                    !ghc::filesystem::exists(m_binDirectory) &&
-                    !ghc::filesystem::create_directories(m_binDirectory)
-                ) {
-                    return errorFunc("Unable to create directory at " + m_binDirectory.string());
+
+    auto started = DownloadTelemetry::now();
+    auto install = [this, errorFunc, finishFunc, started](ghc::filesystem::path const& file) -> void {
+        try {
+            if (
+                !ghc::filesystem::exists(m_binDirectory) &&
+                !ghc::filesystem::create_directories(m_binDirectory)
+            ) {
+                return errorFunc("Unable to create directory at " + m_binDirectory.string());
+            }
+            // the installed library may be linked into 
+            // the CLI's backup, so replace it with a new 
+            // file instead of writing through it
+            auto target = m_binDirectory / GEODE_UTILS_LIB;
+            auto temp = target;
+            temp += GEODE_UTILS_TEMP_SUFFIX;
+            if (!ghc::filesystem::copy_file(
+                file, temp,
+                ghc::filesystem::copy_options::overwrite_existing
+            )) {
+                return errorFunc("Unable to copy geodeutils dll!");
+            }
+            std::error_code ec;
+            ghc::filesystem::rename(temp, target, ec);
+            if (ec) {
+                ghc::filesystem::remove(temp, ec);
+                return errorFunc("Unable to replace geodeutils dll!");
+            }
+            this->recordStage("geodeutils", started, ghc::filesystem::file_size(file));
+            finishFunc();
+        } catch(std::exception& e) {
+            return errorFunc(e.what());
+        }
+    };
+
+    auto download = [this, url, errorFunc, progressFunc, install](std::string const& digest) -> void {
+        this->downloadFile(url, errorFunc, progressFunc, install, DOWNLOAD_SEGMENTS, digest);
+    };
+
+    // patches are published per installed version, 
+    // identified by its hash since the library has 
+    // no version of its own, and listed one hash per 
+    // line in <lib>.patches so that versions without 
+    // one don't cost a failed request. if there's no 
+    // patch or it doesn't apply, download the whole thing
+    auto patch = [this, url, progressFunc, finishFunc, install, download](
+        std::string const& digest
+    ) -> void {
+        auto installed = m_binDirectory / GEODE_UTILS_LIB;
+        auto current = ghc::filesystem::exists(installed) ?
+            SHA256::hashFile(installed) : std::string();
+        if (current.empty()) {
+            return download(digest);
+        }
+        if (current == digest) {
+            return finishFunc();
+        }
+        this->fetchMetadata(
+            url + ".patches",
+            [download, digest](std::string const&) -> void {
+                download(digest);
+            },
+            [this, url, current, digest, installed, progressFunc, install, download](
+                std::string const& body
+            ) -> void {
+                std::istringstream list(body);
+                std::string line;
+                auto listed = false;
+                while (!listed && std::getline(list, line)) {
+                    listed = normalizeDigest(line.substr(0, line.find_first_of(" \t\r"))) == current;
                 }
-                if (!ghc::filesystem::copy_file(
-                    res.GetDataFile().ToStdWstring(),
-                    m_binDirectory / res.GetSuggestedFileName().ToStdWstring(),
-                    ghc::filesystem::copy_options::overwrite_existing
-                )) {
-                    return errorFunc("Unable to copy geodeutils dll!");
+                if (!listed) {
+                    return download(digest);
                 }
-                finishFunc();
-            } catch(std::exception& e) {
-                return errorFunc(e.what());
+                this->downloadFile(
+                    url + ".patch-" + current,
+                    [download, digest](std::string const&) -> void {
+                        download(digest);
+                    },
+                    progressFunc,
+                    [this, installed, digest, install, download](ghc::filesystem::path const& patchFile) -> void {
+                        auto patched = this->getDownloadsDirectory() / GEODE_UTILS_LIB;
+                        auto res = applyBinaryPatch(installed, patchFile, patched);
+                        if (!res || SHA256::hashFile(patched) != digest) {
+                            std::error_code ec;
+                            ghc::filesystem::remove(patched, ec);
+                            return download(digest);
+                        }
+                        install(patched);
+                        std::error_code ec;
+                        ghc::filesystem::remove(patched, ec);
+                    }
+                );
             }
-        }
+        );
+    };
+
+    // the digest is published next to the library in 
+    // sha256sum format; branches that don't have one 
+    // yet are installed without verification, but 
+    // not being able to get one that exists is 
+    // as bad as a wrong one. A digest cached from 
+    // before the library was last published would 
+    // fail every download, so it's always checked 
+    // with the server
+    this->fetchMetadata(
+        url + ".sha256",
+        [errorFunc, download](std::string const& error) -> void {
+            if (error == statusError(404)) {
+                return download("");
+            }
+            errorFunc("Unable to get the checksum of " GEODE_UTILS_LIB ": " + error);
+        },
+        [errorFunc, download, patch, update](std::string const& body) -> void {
+            auto digest = body.substr(0, body.find_first_of(" \t\r\n"));
+            if (
+                digest.size() != 64 ||
+                digest.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos
+            ) {
+                return errorFunc("Invalid checksum file for " GEODE_UTILS_LIB);
+            }
+            digest = normalizeDigest(digest);
+            // patching is only safe with a known 
+            // digest to check the result against
+            if (update) {
+                return patch(digest);
+            }
+            download(digest);
+        },
+        RequestPriority::Interactive,
+        true
     );
 }
 
@@ -700,8 +2448,6 @@ Result<> Manager::installGeodeFor(
         return Err("Geode Utility Library seems to not have been installed");
     }
 
-    this->Bind(CALL_ON_MAIN, &Manager::onSyncThreadCall, this);
-
     std::thread t([this, gdExePath, branch, errorFunc, progressFunc, finishFunc]() -> void {
         auto throwError = [errorFunc, this](std::string const& msg) -> void {
             wxQueueEvent(this, new CallOnMainEvent(
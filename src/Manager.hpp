@@ -7,9 +7,21 @@
 #include "include/Result.hpp"
 #include "legacy/optional.hpp"
 #include <wx/webrequest.h>
+#include <wx/stream.h>
 #include <functional>
 #include "include/VersionInfo.hpp"
 #include "include/json.hpp"
+#include "DownloadCache.hpp"
+#include "MetadataCache.hpp"
+#include "DownloadTelemetry.hpp"
+#include "MirrorList.hpp"
+#include "RequestScheduler.hpp"
+#include "RequestRegistry.hpp"
+#include "ExtractIndex.hpp"
+#include "FixtureServer.hpp"
+#include <deque>
+#include <array>
+#include <atomic>
 
 enum class DevBranch : bool {
     Stable,
@@ -52,6 +64,17 @@ enum OtherModFlags {
     OMF_GDHM = 0b1000,
 };
 
+/**
+ * How long one stage of an install took, 
+ * like fetching metadata or extracting
+ */
+struct StageTiming {
+    std::string m_name;
+    long long m_duration;
+    size_t m_bytes;
+    std::string m_details;
+};
+
 enum class InstallerMode {
     Normal,
     UpdateLoader,
@@ -60,10 +83,18 @@ enum class InstallerMode {
 using DownloadErrorFunc = std::function<void(std::string const&)>;
 using DownloadProgressFunc = std::function<void(std::string const&, int)>;
 using DownloadFinishFunc = std::function<void(wxWebResponse const&)>;
+using DownloadFileFinishFunc = std::function<void(ghc::filesystem::path const&)>;
+using MetadataFinishFunc = std::function<void(std::string const&)>;
+using JsonFinishFunc = std::function<void(nlohmann::json const&)>;
+using WebRequestEventFunc = std::function<void(wxWebRequestEvent&)>;
+using DownloadTelemetryFunc = std::function<void(DownloadTelemetry const&)>;
+using DownloadStreamFunc = std::function<Result<>(wxInputStream&)>;
 using CloneFinishFunc = std::function<void()>;
 using UpdateCheckFinishFunc = std::function<void(VersionInfo const&, VersionInfo const&)>;
 
 class GeodeInstallerApp;
+class PartialDownload;
+struct SegmentedDownload;
 
 namespace cli {
     using ProgressCallback = void(__stdcall*)(const char*, int);
@@ -86,6 +117,29 @@ public:
     wxEvent* Clone() const override { return new CallOnMainEvent(*this); }
 };
 
+struct WebRequestHandlers {
+    wxWebRequest m_request;
+    WebRequestEventFunc m_stateFunc;
+    WebRequestEventFunc m_dataFunc;
+    std::function<void()> m_stallFunc;
+    std::unique_ptr<wxTimer> m_stallTimer;
+    DownloadTelemetry m_telemetry;
+};
+
+struct JsonRequestCallbacks {
+    DownloadErrorFunc m_errorFunc;
+    JsonFinishFunc m_finishFunc;
+};
+
+struct PendingJson {
+    /**
+     * Not set if the document came from 
+     * the metadata cache
+     */
+    wxWebRequest m_request;
+    std::vector<JsonRequestCallbacks> m_callbacks;
+};
+
 class Manager : public wxEvtHandler {
 protected:
     ghc::filesystem::path m_dataDirectory;
@@ -99,6 +153,42 @@ protected:
     ghc::filesystem::path m_loaderUpdatePath;
     nlohmann::json m_loadedConfigJson;
     VersionInfo m_CLIVersion;
+    int m_nextRequestID = wxID_HIGHEST + 1;
+    /**
+     * All requests go through one session so 
+     * that connections to a host are kept alive 
+     * & reused instead of doing a new TLS 
+     * handshake for every request
+     */
+    wxWebSession m_session;
+    /**
+     * Which requests are waiting for a free 
+     * slot & which are running
+     */
+    RequestScheduler m_scheduler;
+    /**
+     * Handlers of running web requests
+     */
+    RequestRegistry<WebRequestHandlers> m_requests;
+    std::unique_ptr<DownloadCache> m_downloadCache;
+    std::unique_ptr<ExtractIndex> m_extractIndex;
+    std::unique_ptr<MetadataCache> m_metadataCache;
+    std::unique_ptr<MirrorList> m_mirrors;
+    /**
+     * Telemetry of the most recently finished 
+     * requests, oldest first
+     */
+    std::deque<DownloadTelemetry> m_telemetryHistory;
+    DownloadTelemetryFunc m_telemetryFunc;
+    /**
+     * Callers waiting on a JSON document by URL. 
+     * Only the first caller for a URL sends a 
+     * request; the rest are added here and get 
+     * the same parsed result
+     */
+    std::unordered_map<std::string, PendingJson> m_pendingJson;
+    std::vector<StageTiming> m_stageTimings;
+    std::unique_ptr<FixtureServer> m_fixtureServer;
 
     void* loadFunctionFromUtilsLib(const char* name);
     template<typename Func>
@@ -106,16 +196,206 @@ protected:
         return reinterpret_cast<Func>(this->loadFunctionFromUtilsLib(name));
     }
 
-    void webRequest(
+    Manager();
+
+    /**
+     * Create a request that reports its events 
+     * to Manager. Unless useMirrors is false, the 
+     * URL is sent to the best ranked mirror
+     */
+    wxWebRequest createRequest(std::string const& url, bool useMirrors = true);
+    void handleRequestState(wxWebRequest const& request, WebRequestEventFunc func);
+    void handleRequestData(wxWebRequest const& request, WebRequestEventFunc func);
+    /**
+     * Called once if the request goes without 
+     * receiving any data for too long
+     */
+    void handleRequestStall(wxWebRequest const& request, std::function<void()> func);
+    /**
+     * Start the request once there's room for 
+     * it. Higher priority requests go first, 
+     * and some slots are always kept free for 
+     * more important requests than bulk & 
+     * speculative ones
+     */
+    void startRequest(wxWebRequest const& request, RequestPriority priority);
+    void startQueuedRequests();
+    void startStallTimer(WebRequestHandlers& handlers, int id);
+    /**
+     * Move a request to a more important 
+     * priority, e.g. when someone starts 
+     * waiting on a speculative one
+     */
+    void raiseRequestPriority(wxWebRequest const& request, RequestPriority priority);
+    size_t getMaxRequests() const;
+    wxWebSession& getSession();
+    void onWebRequestState(wxWebRequestEvent&);
+    void onWebRequestData(wxWebRequestEvent&);
+    /**
+     * Keep the telemetry of a finished download 
+     * in the history & pass it on
+     */
+    void recordTelemetry(DownloadTelemetry const& telemetry);
+
+    /**
+     * If dataFunc is set, the body isn't stored 
+     * in the response but given to it as it 
+     * arrives
+     */
+    wxWebRequest webRequest(
         std::string const& url,
-        bool downloadFile,
         DownloadErrorFunc errorFunc,
         DownloadProgressFunc progressFunc,
-        DownloadFinishFunc finishFunc
+        DownloadFinishFunc finishFunc,
+        std::unordered_map<std::string, std::string> const& headers = {},
+        RequestPriority priority = RequestPriority::Interactive,
+        WebRequestEventFunc dataFunc = nullptr
     );
+    /**
+     * Fetch a small text document such as a 
+     * version list. Responses are cached; a 
+     * cached response younger than the metadata 
+     * TTL is returned without a request, and 
+     * older ones are revalidated with a 
+     * conditional request. With revalidate, even 
+     * fresh responses are revalidated, for 
+     * documents that must never be stale like 
+     * checksums. Responses may come gzipped and 
+     * are decoded while they arrive. Returns the 
+     * request, or an invalid one if the cache 
+     * was used
+     */
+    wxWebRequest fetchMetadata(
+        std::string const& url,
+        DownloadErrorFunc errorFunc,
+        MetadataFinishFunc finishFunc,
+        RequestPriority priority = RequestPriority::Interactive,
+        bool revalidate = false
+    );
+    /**
+     * Fetch & parse a JSON metadata document. 
+     * Concurrent calls for the same URL share 
+     * one request and one parsed document, 
+     * which runs at the most important 
+     * priority any of them asked for
+     */
+    void fetchJson(
+        std::string const& url,
+        DownloadErrorFunc errorFunc,
+        JsonFinishFunc finishFunc,
+        RequestPriority priority = RequestPriority::Interactive
+    );
+    static std::string getVersionsURL(DevBranch branch);
+    /**
+     * Download a file into the downloads directory. 
+     * Received data is kept if the transfer fails, 
+     * and later attempts to download the same URL 
+     * continue from where the last one stopped.
+     * If segments is more than 1 and the server 
+     * supports range requests, the file is split 
+     * into that many parts which are downloaded 
+     * at the same time.
+     * Finished downloads are kept in the download 
+     * cache; release assets found there are used 
+     * without a request, other cached files are 
+     * revalidated with the server first.
+     * The file passed to finishFunc may be the 
+     * cached copy, so it must not be modified.
+     * If digest is given, the SHA-256 of the file 
+     * (hashed while it's being received) must 
+     * match it, otherwise the download fails and 
+     * the file is thrown away
+     */
+    void downloadFile(
+        std::string const& url,
+        DownloadErrorFunc errorFunc,
+        DownloadProgressFunc progressFunc,
+        DownloadFileFinishFunc finishFunc,
+        size_t segments = 1,
+        std::string const& digest = ""
+    );
+    void downloadFileStream(
+        std::string const& url,
+        std::string const& digest,
+        DownloadErrorFunc errorFunc,
+        DownloadProgressFunc progressFunc,
+        DownloadFileFinishFunc finishFunc,
+        int attemptsLeft
+    );
+    void downloadFileSegment(
+        std::shared_ptr<SegmentedDownload> download,
+        size_t index,
+        int attemptsLeft
+    );
+    /**
+     * Download a file and hand the data to the 
+     * consumer as it arrives. The consumer runs 
+     * on a worker thread and reads from a stream 
+     * that blocks until more data is received. 
+     * The data is checked against the digest as 
+     * it goes by & isn't kept anywhere, so it 
+     * doesn't end up in the download cache
+     */
+    void streamFile(
+        std::string const& url,
+        std::string const& digest,
+        DownloadErrorFunc errorFunc,
+        DownloadProgressFunc progressFunc,
+        DownloadStreamFunc consumer,
+        CloneFinishFunc finishFunc
+    );
+    /**
+     * Check a finished download against the 
+     * expected SHA-256 digest (if any) and 
+     * move it into the download cache. Files 
+     * that don't match are deleted
+     */
+    void finishDownload(
+        PartialDownload& part,
+        std::string const& digest,
+        DownloadErrorFunc errorFunc,
+        DownloadFileFinishFunc finishFunc
+    );
+    void finishFromCache(
+        std::string const& url,
+        std::string const& digest,
+        DownloadErrorFunc errorFunc,
+        DownloadProgressFunc progressFunc,
+        DownloadFileFinishFunc finishFunc
+    );
+    /**
+     * extractArchive onto the disk
+     */
     Result<> unzipTo(
         ghc::filesystem::path const& zip,
-        ghc::filesystem::path const& to
+        ghc::filesystem::path const& to,
+        ExtractIndex* index = nullptr,
+        ghc::filesystem::path const& current = ghc::filesystem::path()
+    );
+    /**
+     * extractStream onto the disk
+     */
+    Result<> unzipFrom(
+        wxInputStream& zip,
+        ghc::filesystem::path const& to,
+        ExtractIndex* index = nullptr,
+        ghc::filesystem::path const& current = ghc::filesystem::path()
+    );
+    /**
+     * Put the directory at from in place of the 
+     * one at to, which is moved to backup. On 
+     * macOS this is one atomic swap, elsewhere 
+     * two renames
+     */
+    Result<> replaceDirectory(
+        ghc::filesystem::path const& from,
+        ghc::filesystem::path const& to,
+        ghc::filesystem::path const& backup
+    );
+    void findCLIAsset(
+        DownloadErrorFunc errorFunc,
+        DownloadProgressFunc progressFunc,
+        std::function<void(std::string const& url, std::string const& digest)> foundFunc
     );
     Result<> addSuiteEnv();
  
@@ -133,8 +413,103 @@ public:
 
     bool isFirstTime() const;
 
+    /**
+     * Number of web requests whose handlers are 
+     * still registered, i.e. that haven't finished
+     */
+    size_t getActiveRequestCount() const;
+    size_t getTotalRequestCount() const;
+
+    /**
+     * Telemetry of a running request, or 
+     * nullptr if it has already finished
+     */
+    DownloadTelemetry const* getTelemetry(wxWebRequest const& request) const;
+    std::deque<DownloadTelemetry> const& getTelemetryHistory() const;
+    /**
+     * Called whenever a request receives data 
+     * and once more when it finishes
+     */
+    void setTelemetryFunc(DownloadTelemetryFunc func);
+    /**
+     * Progress text of a running request with 
+     * its size, speed & time left
+     */
+    std::string getProgressText(wxWebRequest const& request) const;
+
     ghc::filesystem::path const& getDataDirectory() const;
     ghc::filesystem::path getDefaultDataDirectory() const;
+    ghc::filesystem::path getDownloadsDirectory() const;
+    ghc::filesystem::path getDownloadCacheDirectory() const;
+    DownloadCache& getDownloadCache();
+    ExtractIndex& getExtractIndex();
+    MetadataCache& getMetadataCache();
+    /**
+     * Mirrors from the "mirrors" list in the 
+     * config. Ranking starts out in config order 
+     * and is updated by every finished request
+     */
+    MirrorList& getMirrors();
+    /**
+     * Send a HEAD request to every mirror to 
+     * measure its latency
+     */
+    void probeMirrors();
+
+    /**
+     * Start fetching the version lists of all 
+     * known installations in the background, 
+     * so update checks can be answered from 
+     * the metadata cache
+     */
+    void prefetchUpdateMetadata();
+    /**
+     * Cancel all speculative requests that 
+     * nobody has started waiting on
+     */
+    void cancelSpeculativeRequests();
+
+    /**
+     * Serve the files in the directory from a 
+     * local server & send every request there 
+     * instead of to the mirrors or the real 
+     * hosts, to run the download pipeline 
+     * without the internet. Requests for 
+     * anything else fail to be created
+     */
+    Result<> startFixtureServer(
+        ghc::filesystem::path const& directory,
+        FixtureServerOptions const& options
+    );
+    FixtureServer* getFixtureServer() const;
+    /**
+     * Fetch the version list & install the CLI and 
+     * geodeutils from the fixture server, recording 
+     * how long each stage takes. Everything goes in 
+     * the given scratch directory instead of the 
+     * real data & bin directories, and it's emptied 
+     * first so every run starts cold
+     */
+    void runFixtureBenchmark(
+        ghc::filesystem::path const& directory,
+        DownloadErrorFunc errorFunc,
+        CloneFinishFunc finishFunc
+    );
+
+    /**
+     * Record that a stage started at the given 
+     * DownloadTelemetry::now() time has finished. 
+     * When running against a fixture server the 
+     * timings are also appended to a log in the 
+     * data directory
+     */
+    void recordStage(
+        std::string const& name,
+        long long started,
+        size_t bytes = 0,
+        std::string const& details = ""
+    );
+    std::vector<StageTiming> const& getStageTimings() const;
 
     ghc::filesystem::path const& getBinDirectory() const;
     ghc::filesystem::path getDefaultBinDirectory() const;
@@ -150,14 +525,44 @@ public:
     Result<> saveData();
     Result<> deleteData();
 
-    void downloadCLI(
-        DownloadErrorFunc errorFunc,
-        DownloadProgressFunc progressFunc,
-        DownloadFinishFunc finishFunc
-    );
     Result<> installCLI(
         ghc::filesystem::path const& cliZipPath
     );
+    /**
+     * Move a CLI extracted into stagingDir 
+     * into the bin directory. The previous bin 
+     * directory is kept next to it
+     */
+    Result<> installStagedCLI(
+        ghc::filesystem::path const& stagingDir
+    );
+    /**
+     * Go back to the bin directory from before 
+     * the last CLI install
+     */
+    Result<> rollbackCLI();
+    /**
+     * Siblings of the bin directory that new CLI 
+     * versions are extracted into & the last 
+     * version is kept in
+     */
+    ghc::filesystem::path getCLIStagingDirectory() const;
+    ghc::filesystem::path getCLIBackupDirectory() const;
+    /**
+     * Download the CLI and extract it while it's 
+     * still downloading, without writing the 
+     * archive out and reading it back first. 
+     * The archive isn't kept, so it's downloaded 
+     * again every time. installErrorFunc is 
+     * called instead of errorFunc if the CLI was 
+     * downloaded but couldn't be moved into place
+     */
+    void downloadAndInstallCLI(
+        DownloadErrorFunc errorFunc,
+        DownloadErrorFunc installErrorFunc,
+        DownloadProgressFunc progressFunc,
+        CloneFinishFunc finishFunc
+    );
 
     void setCLIVersion(VersionInfo const&);
 
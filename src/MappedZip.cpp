@@ -0,0 +1,229 @@
+#include "MappedZip.hpp"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define ZIP_LOCAL_HEADER_SIG 0x04034b50
+#define ZIP_CENTRAL_HEADER_SIG 0x02014b50
+#define ZIP_END_RECORD_SIG 0x06054b50
+#define ZIP_LOCAL_HEADER_SIZE 30
+#define ZIP_CENTRAL_HEADER_SIZE 46
+#define ZIP_END_RECORD_SIZE 22
+// general purpose flags
+#define ZIP_FLAG_ENCRYPTED 0x0001
+#define ZIP_FLAG_UTF8 0x0800
+#define ZIP_METHOD_STORE 0
+#define ZIP_METHOD_DEFLATE 8
+
+static uint16_t read16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+static uint32_t read32(const uint8_t* data) {
+    return
+        static_cast<uint32_t>(data[0]) |
+        static_cast<uint32_t>(data[1]) << 8 |
+        static_cast<uint32_t>(data[2]) << 16 |
+        static_cast<uint32_t>(data[3]) << 24;
+}
+
+MappedFile::~MappedFile() {
+    this->close();
+}
+
+Result<> MappedFile::open(ghc::filesystem::path const& path) {
+    this->close();
+    #ifdef _WIN32
+    auto file = CreateFileW(
+        path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return Err("Unable to open " + path.string());
+    }
+    m_file = file;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+        this->close();
+        return Err("Unable to map " + path.string());
+    }
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) {
+        this->close();
+        return Err("Unable to map " + path.string());
+    }
+    auto view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        this->close();
+        return Err("Unable to map " + path.string());
+    }
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(size.QuadPart);
+    #else
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return Err("Unable to open " + path.string());
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return Err("Unable to map " + path.string());
+    }
+    auto view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file alive
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return Err("Unable to map " + path.string());
+    }
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(info.st_size);
+    #endif
+    return Ok();
+}
+
+void MappedFile::close() {
+    #ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+    #else
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+    #endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+const uint8_t* MappedFile::getData() const {
+    return m_data;
+}
+
+size_t MappedFile::getSize() const {
+    return m_size;
+}
+
+bool MappedZipEntry::isDir() const {
+    return m_name.size() && m_name.back() == '/';
+}
+
+Result<> MappedZip::open(ghc::filesystem::path const& path) {
+    m_entries.clear();
+    auto res = m_file.open(path);
+    if (!res) return res;
+    return this->readCentralDirectory();
+}
+
+Result<> MappedZip::readCentralDirectory() {
+    auto data = m_file.getData();
+    auto size = m_file.getSize();
+    if (size < ZIP_END_RECORD_SIZE) {
+        return Err("Not a zip file");
+    }
+
+    // the end record is followed by a comment 
+    // of up to 64k, so search backwards
+    const uint8_t* end = nullptr;
+    auto last = size - ZIP_END_RECORD_SIZE;
+    auto first = last > 0xffff ? last - 0xffff : 0;
+    for (auto pos = last + 1; pos-- > first;) {
+        if (read32(data + pos) == ZIP_END_RECORD_SIG) {
+            end = data + pos;
+            break;
+        }
+    }
+    if (!end) {
+        return Err("Not a zip file");
+    }
+    auto disk = read16(end + 4);
+    auto count = read16(end + 10);
+    auto dirSize = read32(end + 12);
+    auto dirOffset = read32(end + 16);
+    if (disk != 0 || count == 0xffff || dirSize == 0xffffffff || dirOffset == 0xffffffff) {
+        return Err("Zip64 & multi-disk archives aren't supported");
+    }
+    if (static_cast<size_t>(dirOffset) + dirSize > size) {
+        return Err("Zip central directory is out of bounds");
+    }
+
+    auto pos = data + dirOffset;
+    auto dirEnd = pos + dirSize;
+    m_entries.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (pos + ZIP_CENTRAL_HEADER_SIZE > dirEnd || read32(pos) != ZIP_CENTRAL_HEADER_SIG) {
+            return Err("Zip central directory is corrupted");
+        }
+        auto flags = read16(pos + 8);
+        auto nameSize = read16(pos + 28);
+        auto extraSize = read16(pos + 30);
+        auto commentSize = read16(pos + 32);
+        auto next = pos + ZIP_CENTRAL_HEADER_SIZE + nameSize + extraSize + commentSize;
+        if (next > dirEnd) {
+            return Err("Zip central directory is corrupted");
+        }
+        if (flags & ZIP_FLAG_ENCRYPTED) {
+            return Err("Encrypted zips aren't supported");
+        }
+
+        MappedZipEntry entry;
+        entry.m_name.assign(
+            reinterpret_cast<const char*>(pos + ZIP_CENTRAL_HEADER_SIZE), nameSize
+        );
+        // other encodings are left to wx
+        if (!(flags & ZIP_FLAG_UTF8)) {
+            for (auto c : entry.m_name) {
+                if (static_cast<unsigned char>(c) >= 0x80) {
+                    return Err("Zip entry names aren't UTF-8");
+                }
+            }
+        }
+        entry.m_method = read16(pos + 10);
+        if (entry.m_method != ZIP_METHOD_STORE && entry.m_method != ZIP_METHOD_DEFLATE) {
+            return Err("Compression method " + std::to_string(entry.m_method) + " isn't supported");
+        }
+        entry.m_crc = read32(pos + 16);
+        entry.m_compressedSize = read32(pos + 20);
+        entry.m_size = read32(pos + 24);
+        entry.m_headerOffset = read32(pos + 42);
+        if (
+            entry.m_compressedSize == 0xffffffff ||
+            entry.m_size == 0xffffffff ||
+            entry.m_headerOffset == 0xffffffff
+        ) {
+            return Err("Zip64 & multi-disk archives aren't supported");
+        }
+        m_entries.push_back(entry);
+        pos = next;
+    }
+    return Ok();
+}
+
+std::vector<MappedZipEntry> const& MappedZip::getEntries() const {
+    return m_entries;
+}
+
+Result<const uint8_t*> MappedZip::getData(MappedZipEntry const& entry) const {
+    auto data = m_file.getData();
+    auto size = m_file.getSize();
+    if (entry.m_headerOffset + ZIP_LOCAL_HEADER_SIZE > size) {
+        return Err("Zip entry \"" + entry.m_name + "\" is out of bounds");
+    }
+    auto header = data + entry.m_headerOffset;
+    if (read32(header) != ZIP_LOCAL_HEADER_SIG) {
+        return Err("Zip entry \"" + entry.m_name + "\" is corrupted");
+    }
+    // the local header's extra field can differ 
+    // from the one in the central directory
+    auto start = entry.m_headerOffset + ZIP_LOCAL_HEADER_SIZE +
+        read16(header + 26) + read16(header + 28);
+    if (start + entry.m_compressedSize > size) {
+        return Err("Zip entry \"" + entry.m_name + "\" is out of bounds");
+    }
+    return Ok(data + start);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A whole file mapped read-only into memory
+ */
+class MappedFile {
+protected:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    #ifdef _WIN32
+    // HANDLEs, kept opaque so this header 
+    // doesn't pull in windows.h
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+    #endif
+
+public:
+    MappedFile() = default;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+    ~MappedFile();
+
+    Result<> open(ghc::filesystem::path const& path);
+    void close();
+
+    const uint8_t* getData() const;
+    size_t getSize() const;
+};
+
+struct MappedZipEntry {
+    /**
+     * Name as stored in the archive, UTF-8
+     */
+    std::string m_name;
+    uint16_t m_method;
+    uint32_t m_crc;
+    size_t m_compressedSize;
+    size_t m_size;
+    size_t m_headerOffset;
+
+    bool isDir() const;
+};
+
+/**
+ * Zip archive read straight from a mapping of 
+ * the file. The central directory is parsed 
+ * once, and the data of every entry can be 
+ * accessed in place from any thread.
+ * 
+ * Only covers what the installer's archives 
+ * use: stored & deflated entries, no Zip64, 
+ * encryption or multi-disk archives. open() 
+ * fails on others so the caller can use 
+ * wxZipInputStream instead
+ */
+class MappedZip {
+protected:
+    MappedFile m_file;
+    std::vector<MappedZipEntry> m_entries;
+
+    Result<> readCentralDirectory();
+
+public:
+    Result<> open(ghc::filesystem::path const& path);
+
+    std::vector<MappedZipEntry> const& getEntries() const;
+    /**
+     * Pointer to the entry's data as stored, 
+     * m_compressedSize bytes long
+     */
+    Result<const uint8_t*> getData(MappedZipEntry const& entry) const;
+};
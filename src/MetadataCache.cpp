@@ -0,0 +1,107 @@
+#include "MetadataCache.hpp"
+#include "include/json.hpp"
+#include <fstream>
+#include <chrono>
+
+MetadataCache::MetadataCache(
+    ghc::filesystem::path const& path,
+    long long ttlSeconds
+) : m_path(path), m_ttl(ttlSeconds) {}
+
+long long MetadataCache::now() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+Result<> MetadataCache::load() {
+    m_entries.clear();
+    if (!ghc::filesystem::exists(m_path)) {
+        return Ok();
+    }
+    try {
+        std::ifstream ifs(m_path);
+        auto json = nlohmann::json::parse(ifs);
+        for (auto& [url, item] : json.items()) {
+            MetadataCacheEntry entry;
+            entry.m_body = item["body"].get<std::string>();
+            entry.m_etag = item["etag"].get<std::string>();
+            entry.m_lastModified = item["last-modified"].get<std::string>();
+            entry.m_fetched = item["fetched"].get<long long>();
+            m_entries.insert({ url, entry });
+        }
+    } catch(std::exception& e) {
+        m_entries.clear();
+        return Err("Unable to parse metadata cache: " + std::string(e.what()));
+    }
+    return Ok();
+}
+
+Result<> MetadataCache::save() {
+    auto dir = m_path.parent_path();
+    if (
+        !ghc::filesystem::exists(dir) &&
+        !ghc::filesystem::create_directories(dir)
+    ) {
+        return Err("Unable to create directory " + dir.string());
+    }
+    auto json = nlohmann::json::object();
+    for (auto& [url, entry] : m_entries) {
+        json[url] = {
+            { "body", entry.m_body },
+            { "etag", entry.m_etag },
+            { "last-modified", entry.m_lastModified },
+            { "fetched", entry.m_fetched },
+        };
+    }
+    std::ofstream ofs(m_path);
+    if (!ofs.is_open()) {
+        return Err("Unable to write metadata cache");
+    }
+    ofs << json.dump();
+    return Ok();
+}
+
+MetadataCacheEntry const* MetadataCache::find(std::string const& url) const {
+    auto it = m_entries.find(url);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+bool MetadataCache::isFresh(MetadataCacheEntry const& entry) const {
+    return MetadataCache::now() - entry.m_fetched < m_ttl * 1000;
+}
+
+void MetadataCache::store(
+    std::string const& url,
+    std::string const& body,
+    std::string const& etag,
+    std::string const& lastModified
+) {
+    auto& entry = m_entries[url];
+    entry.m_body = body;
+    entry.m_etag = etag;
+    entry.m_lastModified = lastModified;
+    entry.m_fetched = MetadataCache::now();
+    this->save();
+}
+
+MetadataCacheEntry const* MetadataCache::revalidated(std::string const& url) {
+    auto it = m_entries.find(url);
+    if (it == m_entries.end()) {
+        return nullptr;
+    }
+    it->second.m_fetched = MetadataCache::now();
+    this->save();
+    return &it->second;
+}
+
+void MetadataCache::setTTL(long long seconds) {
+    m_ttl = seconds;
+}
+
+long long MetadataCache::getTTL() const {
+    return m_ttl;
+}
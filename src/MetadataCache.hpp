@@ -0,0 +1,57 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include <string>
+#include <unordered_map>
+
+struct MetadataCacheEntry {
+    std::string m_body;
+    std::string m_etag;
+    std::string m_lastModified;
+    /**
+     * When the server last confirmed the body, 
+     * in milliseconds since epoch
+     */
+    long long m_fetched = 0;
+};
+
+/**
+ * Cache of small metadata responses (version
+ * lists, release info) with the validators
+ * needed to revalidate them with a conditional
+ * request. Entries younger than the TTL are
+ * used without asking the server at all
+ */
+class MetadataCache {
+protected:
+    ghc::filesystem::path m_path;
+    long long m_ttl;
+    std::unordered_map<std::string, MetadataCacheEntry> m_entries;
+
+public:
+    MetadataCache(ghc::filesystem::path const& path, long long ttlSeconds);
+
+    Result<> load();
+    Result<> save();
+
+    MetadataCacheEntry const* find(std::string const& url) const;
+    bool isFresh(MetadataCacheEntry const& entry) const;
+
+    void store(
+        std::string const& url,
+        std::string const& body,
+        std::string const& etag,
+        std::string const& lastModified
+    );
+    /**
+     * Server answered 304 Not Modified, so the 
+     * entry is fresh again
+     */
+    MetadataCacheEntry const* revalidated(std::string const& url);
+
+    void setTTL(long long seconds);
+    long long getTTL() const;
+
+    static long long now();
+};
@@ -0,0 +1,144 @@
+#include "MirrorList.hpp"
+#include <algorithm>
+
+#define MIRROR_SMOOTHING 0.3
+// size of a "typical" download used to 
+// weigh latency against throughput
+#define MIRROR_SCORE_SIZE (4 * 1024 * 1024)
+// in ms, added to the score for each 
+// failure in a row
+#define MIRROR_FAILURE_PENALTY 30000
+// smaller responses are mostly latency 
+// and say little about throughput
+#define MIRROR_MIN_RATE_SAMPLE (64 * 1024)
+
+static double smooth(double average, double value) {
+    if (average <= 0.0) return value;
+    return MIRROR_SMOOTHING * value + (1.0 - MIRROR_SMOOTHING) * average;
+}
+
+bool Mirror::isOrigin() const {
+    return m_base.empty();
+}
+
+double Mirror::getScore() const {
+    double score = 0.0;
+    if (m_latency >= 0.0) {
+        score += m_latency;
+    }
+    if (m_rate > 0.0) {
+        score += MIRROR_SCORE_SIZE * 1000.0 / m_rate;
+    }
+    return score + m_failures * MIRROR_FAILURE_PENALTY;
+}
+
+MirrorList::MirrorList(std::vector<std::string> const& bases) {
+    for (auto base : bases) {
+        while (base.size() && base.back() == '/') {
+            base.pop_back();
+        }
+        if (base.empty()) continue;
+        Mirror mirror;
+        mirror.m_base = base;
+        m_mirrors.push_back(mirror);
+    }
+    m_mirrors.push_back(Mirror());
+}
+
+void MirrorList::addMirror(std::string base) {
+    while (base.size() && base.back() == '/') {
+        base.pop_back();
+    }
+    if (base.empty()) return;
+    for (auto& mirror : m_mirrors) {
+        if (mirror.m_base == base) return;
+    }
+    Mirror mirror;
+    mirror.m_base = base;
+    m_mirrors.insert(m_mirrors.begin(), mirror);
+}
+
+void MirrorList::useOnly(std::string base) {
+    while (base.size() && base.back() == '/') {
+        base.pop_back();
+    }
+    if (base.empty()) return;
+    Mirror mirror;
+    mirror.m_base = base;
+    m_mirrors = { mirror };
+}
+
+std::vector<Mirror> const& MirrorList::getMirrors() const {
+    return m_mirrors;
+}
+
+std::vector<Mirror> MirrorList::getRanked() const {
+    auto ranked = m_mirrors;
+    std::stable_sort(
+        ranked.begin(), ranked.end(),
+        [](Mirror const& a, Mirror const& b) -> bool {
+            return a.getScore() < b.getScore();
+        }
+    );
+    return ranked;
+}
+
+std::string MirrorList::rewrite(Mirror const& mirror, std::string const& url) {
+    if (mirror.isOrigin()) return url;
+    auto scheme = url.find("://");
+    if (scheme == std::string::npos) return url;
+    return mirror.m_base + "/" + url.substr(scheme + 3);
+}
+
+std::string MirrorList::resolve(std::string const& url) const {
+    if (m_mirrors.size() < 2 && m_mirrors.front().isOrigin()) return url;
+    if (url.rfind("http://", 0) != 0 && url.rfind("https://", 0) != 0) {
+        return url;
+    }
+    for (auto& mirror : m_mirrors) {
+        // already points to a mirror
+        if (!mirror.isOrigin() && url.rfind(mirror.m_base + "/", 0) == 0) {
+            return url;
+        }
+    }
+    return rewrite(this->getRanked().front(), url);
+}
+
+Mirror* MirrorList::findMirror(std::string const& url) {
+    for (auto& mirror : m_mirrors) {
+        if (!mirror.isOrigin() && url.rfind(mirror.m_base + "/", 0) == 0) {
+            return &mirror;
+        }
+    }
+    return &m_mirrors.back();
+}
+
+void MirrorList::report(DownloadTelemetry const& telemetry) {
+    // requests cancelled by the installer, like 
+    // speculative ones or the other segments of 
+    // a failed download, say nothing about the 
+    // mirror unless they were cancelled for stalling
+    if (telemetry.m_cancelled && !telemetry.m_stalled) return;
+    auto mirror = this->findMirror(telemetry.m_url);
+    // a mirror that doesn't have the file is 
+    // as useless as one that's down
+    if (
+        telemetry.m_failed ||
+        telemetry.m_status >= (mirror->isOrigin() ? 500 : 400)
+    ) {
+        mirror->m_failures++;
+        return;
+    }
+    mirror->m_failures = 0;
+    if (telemetry.getTimeToFirstByte() >= 0) {
+        mirror->m_latency = mirror->m_latency >= 0.0 ?
+            smooth(mirror->m_latency, static_cast<double>(telemetry.getTimeToFirstByte())) :
+            static_cast<double>(telemetry.getTimeToFirstByte());
+    }
+    if (
+        telemetry.m_bytesReceived >= MIRROR_MIN_RATE_SAMPLE &&
+        telemetry.m_averageRate > 0.0
+    ) {
+        mirror->m_rate = smooth(mirror->m_rate, telemetry.m_averageRate);
+    }
+}
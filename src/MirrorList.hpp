@@ -0,0 +1,95 @@
+#pragma once
+
+#include "DownloadTelemetry.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * A server that serves the same files as the 
+ * origin. Origin URLs are mapped onto a mirror 
+ * by appending the host & path to its base, so 
+ * https://github.com/a/b on the mirror 
+ * http://localhost:8080 becomes 
+ * http://localhost:8080/github.com/a/b
+ */
+struct Mirror {
+    /**
+     * Empty for the origin servers themselves
+     */
+    std::string m_base;
+    /**
+     * Smoothed time to first byte in ms, 
+     * or -1 if not measured yet
+     */
+    double m_latency = -1.0;
+    /**
+     * Smoothed transfer rate in bytes per 
+     * second, or 0 if not measured yet
+     */
+    double m_rate = 0.0;
+    /**
+     * Failed requests since the last 
+     * successful one
+     */
+    int m_failures = 0;
+
+    bool isOrigin() const;
+    /**
+     * Estimated time in ms to download a typical 
+     * file from this mirror; lower is better. 
+     * Unmeasured mirrors score 0 so that they 
+     * get tried & measured
+     */
+    double getScore() const;
+};
+
+/**
+ * The configured mirrors plus the origin, 
+ * ranked by what requests to them have 
+ * measured so far
+ */
+class MirrorList {
+protected:
+    std::vector<Mirror> m_mirrors;
+
+    Mirror* findMirror(std::string const& url);
+
+public:
+    /**
+     * Mirrors are tried in the given order until 
+     * they have been measured. The origin comes 
+     * after all of them
+     */
+    MirrorList(std::vector<std::string> const& bases);
+
+    /**
+     * Add a mirror that is tried before 
+     * all the others
+     */
+    void addMirror(std::string base);
+    /**
+     * Send every request to this mirror; the 
+     * origin & the other mirrors are dropped, 
+     * even when it fails
+     */
+    void useOnly(std::string base);
+    std::vector<Mirror> const& getMirrors() const;
+    /**
+     * Mirrors from best to worst
+     */
+    std::vector<Mirror> getRanked() const;
+
+    /**
+     * URL of the file on the best ranked mirror
+     */
+    std::string resolve(std::string const& url) const;
+    static std::string rewrite(Mirror const& mirror, std::string const& url);
+
+    /**
+     * Update the stats of whichever mirror the 
+     * request in the telemetry was sent to. 
+     * Cancelled requests are ignored unless 
+     * they had stalled
+     */
+    void report(DownloadTelemetry const& telemetry);
+};
@@ -0,0 +1,365 @@
+#include "PartialDownload.hpp"
+#include "include/json.hpp"
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+
+static std::string hashURL(std::string const& url) {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0')
+       << std::hash<std::string>()(url);
+    return ss.str();
+}
+
+PartialDownload::PartialDownload(
+    ghc::filesystem::path const& directory,
+    std::string const& url
+) : m_url(url) {
+    auto name = hashURL(url);
+    m_path = directory / (name + ".part");
+    m_infoPath = directory / (name + ".json");
+
+    if (
+        !ghc::filesystem::exists(m_path) ||
+        !ghc::filesystem::exists(m_infoPath)
+    ) {
+        this->discard();
+        return;
+    }
+    try {
+        std::ifstream ifs(m_infoPath);
+        auto json = nlohmann::json::parse(ifs);
+        if (json["url"].get<std::string>() != url) {
+            this->discard();
+            return;
+        }
+        m_etag = json["etag"].get<std::string>();
+        m_lastModified = json["last-modified"].get<std::string>();
+        if (json.contains("segments")) {
+            m_total = json["total"].get<size_t>();
+            for (auto& seg : json["segments"]) {
+                DownloadSegment segment;
+                segment.m_start = seg[0].get<size_t>();
+                segment.m_end = seg[1].get<size_t>();
+                segment.m_done = seg[2].get<size_t>();
+                m_segments.push_back(segment);
+            }
+        }
+    } catch(...) {
+        this->discard();
+        return;
+    }
+}
+
+PartialDownload::~PartialDownload() {
+    this->close();
+}
+
+std::string const& PartialDownload::getURL() const {
+    return m_url;
+}
+
+ghc::filesystem::path const& PartialDownload::getPath() const {
+    return m_path;
+}
+
+size_t PartialDownload::getSize() const {
+    std::error_code ec;
+    auto size = ghc::filesystem::file_size(m_path, ec);
+    return ec ? 0 : static_cast<size_t>(size);
+}
+
+std::string PartialDownload::getValidator() const {
+    // weak ETags are not allowed in If-Range
+    if (m_etag.size() && m_etag.rfind("W/", 0) != 0) {
+        return m_etag;
+    }
+    return m_lastModified;
+}
+
+std::string const& PartialDownload::getETag() const {
+    return m_etag;
+}
+
+std::string const& PartialDownload::getLastModified() const {
+    return m_lastModified;
+}
+
+bool PartialDownload::canResume() const {
+    // a segmented download has holes in it, so
+    // the file size doesn't tell how far it got
+    return
+        m_segments.empty() &&
+        this->getSize() > 0 &&
+        this->getValidator().size();
+}
+
+Result<> PartialDownload::saveInfo() {
+    nlohmann::json json;
+    json["url"] = m_url;
+    json["etag"] = m_etag;
+    json["last-modified"] = m_lastModified;
+    if (m_segments.size()) {
+        json["total"] = m_total;
+        json["segments"] = nlohmann::json::array();
+        for (auto& seg : m_segments) {
+            json["segments"].push_back({ seg.m_start, seg.m_end, seg.m_done });
+        }
+    }
+
+    std::ofstream ofs(m_infoPath);
+    if (!ofs.is_open()) {
+        return Err("Unable to write " + m_infoPath.string());
+    }
+    ofs << json.dump();
+    return Ok();
+}
+
+Result<> PartialDownload::createDirectory() {
+    auto dir = m_path.parent_path();
+    if (
+        !ghc::filesystem::exists(dir) &&
+        !ghc::filesystem::create_directories(dir)
+    ) {
+        return Err("Unable to create directory " + dir.string());
+    }
+    return Ok();
+}
+
+void PartialDownload::resetHash() {
+    m_hash = SHA256();
+    m_hashed = 0;
+}
+
+Result<> PartialDownload::hashStored(size_t end) {
+    if (end <= m_hashed) return Ok();
+    if (m_file.is_open()) m_file.flush();
+    if (m_stream.is_open()) m_stream.flush();
+
+    std::ifstream ifs(m_path, std::ios::binary);
+    if (!ifs.is_open()) {
+        return Err("Unable to read " + m_path.string());
+    }
+    ifs.seekg(m_hashed);
+    char buffer[0x10000];
+    while (m_hashed < end) {
+        auto size = std::min(sizeof(buffer), end - m_hashed);
+        if (!ifs.read(buffer, size)) {
+            return Err("Unable to read " + m_path.string());
+        }
+        m_hash.update(buffer, size);
+        m_hashed += size;
+    }
+    return Ok();
+}
+
+size_t PartialDownload::getContiguousSize() const {
+    if (m_segments.empty()) {
+        return this->getSize();
+    }
+    size_t end = 0;
+    for (auto& seg : m_segments) {
+        end = seg.getPosition();
+        if (!seg.isDone()) break;
+    }
+    return end;
+}
+
+Result<std::string> PartialDownload::getHash() {
+    auto res = this->hashStored(this->getContiguousSize());
+    if (!res) return Err(res.error());
+    auto hash = m_hash;
+    return Ok(hash.finish());
+}
+
+Result<> PartialDownload::begin(
+    bool resume,
+    std::string const& etag,
+    std::string const& lastModified
+) {
+    this->close();
+
+    auto res = this->createDirectory();
+    if (!res) return res;
+
+    this->resetHash();
+    if (resume) {
+        // hash what we got last time once, 
+        // the rest is hashed as it arrives
+        auto hashed = this->hashStored(this->getSize());
+        if (!hashed) return hashed;
+    }
+
+    m_etag = etag;
+    m_lastModified = lastModified;
+    m_segments.clear();
+    auto saved = this->saveInfo();
+    if (!saved) return saved;
+
+    m_stream.open(
+        m_path,
+        std::ios::binary | (resume ? std::ios::app : std::ios::trunc)
+    );
+    if (!m_stream.is_open()) {
+        return Err("Unable to open " + m_path.string());
+    }
+    return Ok();
+}
+
+Result<> PartialDownload::write(const void* data, size_t size) {
+    if (!m_stream.is_open()) {
+        return Err("Download file is not open");
+    }
+    m_stream.write(static_cast<const char*>(data), size);
+    if (!m_stream) {
+        return Err("Unable to write to " + m_path.string());
+    }
+    m_hash.update(data, size);
+    m_hashed += size;
+    return Ok();
+}
+
+Result<> PartialDownload::beginSegmented(
+    size_t total,
+    size_t count,
+    std::string const& etag,
+    std::string const& lastModified
+) {
+    this->close();
+
+    auto res = this->createDirectory();
+    if (!res) return res;
+
+    auto validator = etag.size() && etag.rfind("W/", 0) != 0 ? etag : lastModified;
+    if (
+        m_segments.empty() ||
+        m_total != total ||
+        validator.empty() ||
+        validator != this->getValidator() ||
+        this->getSize() != total
+    ) {
+        m_segments.clear();
+        m_total = total;
+        auto size = total / count;
+        for (size_t i = 0; i < count; i++) {
+            DownloadSegment seg;
+            seg.m_start = i * size;
+            seg.m_end = i == count - 1 ? total : (i + 1) * size;
+            m_segments.push_back(seg);
+        }
+        // reserve the whole file up front
+        // so segments can be written anywhere
+        std::ofstream(m_path, std::ios::binary | std::ios::trunc).close();
+        std::error_code ec;
+        ghc::filesystem::resize_file(m_path, total, ec);
+        if (ec) {
+            return Err("Unable to allocate " + m_path.string() + ": " + ec.message());
+        }
+    }
+    m_etag = etag;
+    m_lastModified = lastModified;
+    auto saved = this->saveInfo();
+    if (!saved) return saved;
+
+    m_file.open(m_path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!m_file.is_open()) {
+        return Err("Unable to open " + m_path.string());
+    }
+    this->resetHash();
+    return this->hashStored(this->getContiguousSize());
+}
+
+std::vector<DownloadSegment>& PartialDownload::getSegments() {
+    return m_segments;
+}
+
+size_t PartialDownload::getSegmentedProgress() const {
+    size_t done = 0;
+    for (auto& seg : m_segments) {
+        done += seg.m_done;
+    }
+    return done;
+}
+
+Result<> PartialDownload::writeSegment(size_t index, const void* data, size_t size) {
+    if (!m_file.is_open()) {
+        return Err("Download file is not open");
+    }
+    auto& seg = m_segments.at(index);
+    if (seg.getPosition() + size > seg.m_end) {
+        return Err("Server sent more data than requested");
+    }
+    auto position = seg.getPosition();
+    m_file.seekp(position);
+    m_file.write(static_cast<const char*>(data), size);
+    if (!m_file) {
+        return Err("Unable to write to " + m_path.string());
+    }
+    seg.m_done += size;
+
+    if (position == m_hashed) {
+        m_hash.update(data, size);
+        m_hashed += size;
+        // this segment may have caught up with 
+        // data the next one already wrote
+        if (seg.isDone()) {
+            return this->hashStored(this->getContiguousSize());
+        }
+    }
+    return Ok();
+}
+
+Result<> PartialDownload::saveProgress() {
+    if (m_file.is_open()) {
+        m_file.flush();
+    }
+    return this->saveInfo();
+}
+
+Result<> PartialDownload::close() {
+    bool ok = true;
+    if (m_stream.is_open()) {
+        m_stream.close();
+        ok = ok && m_stream;
+    }
+    if (m_file.is_open()) {
+        m_file.close();
+        ok = ok && m_file;
+        if (ok) {
+            auto res = this->saveInfo();
+            if (!res) return res;
+        }
+    }
+    if (!ok) {
+        return Err("Unable to write to " + m_path.string());
+    }
+    return Ok();
+}
+
+void PartialDownload::discard() {
+    if (m_stream.is_open()) m_stream.close();
+    if (m_file.is_open()) m_file.close();
+    std::error_code ec;
+    ghc::filesystem::remove(m_path, ec);
+    ghc::filesystem::remove(m_infoPath, ec);
+    m_etag.clear();
+    m_lastModified.clear();
+    m_segments.clear();
+    m_total = 0;
+}
+
+bool parseContentRange(
+    std::string const& header,
+    long long& start,
+    long long& total
+) {
+    long long end;
+    if (std::sscanf(header.c_str(), "bytes %lld-%lld/%lld", &start, &end, &total) == 3) {
+        return true;
+    }
+    if (std::sscanf(header.c_str(), "bytes %lld-%lld/*", &start, &end) == 2) {
+        total = -1;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include "include/SHA256.hpp"
+#include <string>
+#include <fstream>
+#include <vector>
+
+/**
+ * A byte range [start, end) of a file that is
+ * downloaded with its own request
+ */
+struct DownloadSegment {
+    size_t m_start;
+    size_t m_end;
+    size_t m_done = 0;
+
+    inline size_t getPosition() const {
+        return m_start + m_done;
+    }
+    inline bool isDone() const {
+        return m_start + m_done >= m_end;
+    }
+};
+
+/**
+ * A file download whose received bytes are kept
+ * in the data directory together with the
+ * validators (ETag / Last-Modified) of the
+ * response they came from, so an interrupted
+ * download can later be continued with a
+ * Range request instead of starting over
+ */
+class PartialDownload {
+protected:
+    ghc::filesystem::path m_path;
+    ghc::filesystem::path m_infoPath;
+    std::string m_url;
+    std::string m_etag;
+    std::string m_lastModified;
+    std::ofstream m_stream;
+    std::fstream m_file;
+    size_t m_total = 0;
+    std::vector<DownloadSegment> m_segments;
+    /**
+     * Hash of the first m_hashed bytes of the 
+     * file. Data is hashed as it's written when 
+     * it continues the hashed part, and read 
+     * back from disk only if it arrived ahead 
+     * of it (other segments, earlier attempts)
+     */
+    SHA256 m_hash;
+    size_t m_hashed = 0;
+
+    Result<> saveInfo();
+    Result<> createDirectory();
+    void resetHash();
+    Result<> hashStored(size_t end);
+    /**
+     * End of the part of the file that has 
+     * been received without gaps
+     */
+    size_t getContiguousSize() const;
+
+public:
+    /**
+     * Picks up an earlier partial download of
+     * the same URL from the directory if one
+     * exists; stale or unreadable ones are
+     * discarded
+     */
+    PartialDownload(
+        ghc::filesystem::path const& directory,
+        std::string const& url
+    );
+    ~PartialDownload();
+
+    std::string const& getURL() const;
+    ghc::filesystem::path const& getPath() const;
+    size_t getSize() const;
+
+    /**
+     * Value for the If-Range header of a resumed
+     * request, or an empty string if the stored
+     * validators can't be used to safely resume
+     */
+    std::string getValidator() const;
+    std::string const& getETag() const;
+    std::string const& getLastModified() const;
+    bool canResume() const;
+
+    /**
+     * Start writing the body of a response. If
+     * resume is false, any data stored so far
+     * is thrown away
+     */
+    Result<> begin(
+        bool resume,
+        std::string const& etag,
+        std::string const& lastModified
+    );
+    Result<> write(const void* data, size_t size);
+
+    /**
+     * Start writing the file as separately
+     * downloaded byte ranges. The progress of an
+     * earlier attempt is kept if it was for the
+     * same version & size of the file
+     */
+    Result<> beginSegmented(
+        size_t total,
+        size_t count,
+        std::string const& etag,
+        std::string const& lastModified
+    );
+    std::vector<DownloadSegment>& getSegments();
+    size_t getSegmentedProgress() const;
+    Result<> writeSegment(size_t index, const void* data, size_t size);
+    Result<> saveProgress();
+
+    /**
+     * SHA-256 of the whole file as a lowercase 
+     * hex string. Only call this once all the 
+     * data has been written
+     */
+    Result<std::string> getHash();
+
+    Result<> close();
+
+    /**
+     * Delete the stored data & validators
+     */
+    void discard();
+};
+
+/**
+ * Parse the start offset & total size out of a
+ * Content-Range header ("bytes 100-199/200").
+ * Total is -1 if the server didn't tell it
+ */
+bool parseContentRange(
+    std::string const& header,
+    long long& start,
+    long long& total
+);
@@ -0,0 +1,59 @@
+#include "PipeStream.hpp"
+#include <cstring>
+#include <algorithm>
+
+size_t PipeInputStream::OnSysRead(void* buffer, size_t size) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cond.wait(lock, [this]() -> bool {
+        return m_failed || m_closed || m_readOffset < m_buffer.size();
+    });
+    if (m_failed) {
+        m_lasterror = wxSTREAM_READ_ERROR;
+        return 0;
+    }
+    auto available = m_buffer.size() - m_readOffset;
+    if (!available) {
+        m_lasterror = wxSTREAM_EOF;
+        return 0;
+    }
+    auto count = std::min(size, available);
+    std::memcpy(buffer, m_buffer.data() + m_readOffset, count);
+    m_readOffset += count;
+
+    // drop what has been read once it's 
+    // most of the buffer
+    if (m_readOffset > 64 * 1024 && m_readOffset * 2 > m_buffer.size()) {
+        m_buffer.erase(0, m_readOffset);
+        m_readOffset = 0;
+    }
+    return count;
+}
+
+void PipeInputStream::write(const void* data, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_buffer.append(static_cast<const char*>(data), size);
+    }
+    m_cond.notify_one();
+}
+
+void PipeInputStream::close() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+    }
+    m_cond.notify_one();
+}
+
+void PipeInputStream::fail() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_failed = true;
+    }
+    m_cond.notify_one();
+}
+
+bool PipeInputStream::hasFailed() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_failed;
+}
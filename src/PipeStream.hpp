@@ -0,0 +1,40 @@
+#pragma once
+
+#include "include/wx.hpp"
+#include <wx/stream.h>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+
+/**
+ * Input stream fed from another thread. Data
+ * written with write() can be read from the
+ * stream on a worker thread, which blocks
+ * until more data arrives or the writer
+ * closes the pipe
+ */
+class PipeInputStream : public wxInputStream {
+protected:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::string m_buffer;
+    size_t m_readOffset = 0;
+    bool m_closed = false;
+    bool m_failed = false;
+
+    size_t OnSysRead(void* buffer, size_t size) override;
+
+public:
+    void write(const void* data, size_t size);
+    /**
+     * No more data is coming; the reader gets 
+     * EOF once the buffer has been read
+     */
+    void close();
+    /**
+     * The data source broke; the reader gets 
+     * a read error
+     */
+    void fail();
+    bool hasFailed();
+};
@@ -0,0 +1,147 @@
+#include "ReleaseInfo.hpp"
+#include "include/json.hpp"
+#include <vector>
+
+/**
+ * Only keeps track of how deep it is and of 
+ * the last key at the levels it cares about: 
+ * the release itself (1) and the objects in 
+ * its "assets" array (3)
+ */
+class ReleaseInfoSax : public nlohmann::json_sax<nlohmann::json> {
+protected:
+    ReleaseInfo& m_info;
+    size_t m_depth = 0;
+    /**
+     * Whether each open container is an object, 
+     * since the levels only mean something if 
+     * they're objects
+     */
+    std::vector<bool> m_objects;
+    std::string m_key;
+    bool m_inAssets = false;
+
+    bool inObject() const {
+        return m_objects.size() && m_objects.back();
+    }
+    bool inRelease() const {
+        return m_depth == 1 && this->inObject();
+    }
+    bool inAsset() const {
+        return m_inAssets && m_depth == 3 && this->inObject();
+    }
+
+public:
+    std::string m_error;
+
+    ReleaseInfoSax(ReleaseInfo& info) : m_info(info) {}
+
+    bool null() override {
+        return true;
+    }
+    bool boolean(bool) override {
+        return true;
+    }
+    bool number_integer(number_integer_t) override {
+        return true;
+    }
+    bool number_unsigned(number_unsigned_t) override {
+        return true;
+    }
+    bool number_float(number_float_t, string_t const&) override {
+        return true;
+    }
+    bool binary(binary_t&) override {
+        return true;
+    }
+
+    bool string(string_t& value) override {
+        if (this->inRelease() && m_key == "tag_name") {
+            m_info.m_tagName = std::move(value);
+        } else if (this->inAsset()) {
+            auto& asset = m_info.m_assets.back();
+            if (m_key == "name") {
+                asset.m_name = std::move(value);
+            } else if (m_key == "browser_download_url") {
+                asset.m_url = std::move(value);
+            } else if (m_key == "digest") {
+                asset.m_digest = std::move(value);
+            }
+        }
+        return true;
+    }
+
+    bool key(string_t& key) override {
+        if (this->inRelease() || this->inAsset()) {
+            m_key = std::move(key);
+        }
+        return true;
+    }
+
+    bool start_object(size_t) override {
+        m_depth++;
+        m_objects.push_back(true);
+        if (this->inAsset()) {
+            m_info.m_assets.emplace_back();
+        }
+        m_key.clear();
+        return true;
+    }
+    bool end_object() override {
+        m_depth--;
+        m_objects.pop_back();
+        return true;
+    }
+
+    bool start_array(size_t) override {
+        m_depth++;
+        // only the release's own "assets" key 
+        if (m_depth == 2 && this->inObject() && m_key == "assets") {
+            m_inAssets = true;
+        }
+        m_objects.push_back(false);
+        return true;
+    }
+    bool end_array() override {
+        if (m_depth == 2) {
+            m_inAssets = false;
+        }
+        m_depth--;
+        m_objects.pop_back();
+        return true;
+    }
+
+    bool parse_error(size_t, std::string const&, nlohmann::detail::exception const& e) override {
+        m_error = e.what();
+        return false;
+    }
+};
+
+Result<ReleaseInfo> ReleaseInfo::parse(std::string const& json) {
+    ReleaseInfo info;
+    ReleaseInfoSax sax(info);
+    if (!nlohmann::json::sax_parse(json, &sax)) {
+        return Err("Unable to parse JSON: " + sax.m_error);
+    }
+    if (info.m_tagName.empty()) {
+        return Err("Release has no tag name");
+    }
+    return Ok(info);
+}
+
+ReleaseAsset const* ReleaseInfo::findAsset(
+    std::string const& part,
+    std::string const& suffix
+) const {
+    for (auto& asset : m_assets) {
+        auto& name = asset.m_name;
+        if (
+            name.find(part) != std::string::npos &&
+            name.size() >= suffix.size() &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0
+        ) {
+            return &asset;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "include/Result.hpp"
+#include <string>
+#include <vector>
+
+struct ReleaseAsset {
+    std::string m_name;
+    std::string m_url;
+    /**
+     * Published SHA-256 digest, like 
+     * "sha256:...", if GitHub has one
+     */
+    std::string m_digest;
+};
+
+/**
+ * The few fields of a GitHub release that 
+ * the installer uses. Release documents list 
+ * the uploader & more for every asset, so 
+ * instead of building a full JSON document 
+ * the fields are picked out of the parser's 
+ * SAX events and everything else is skipped
+ */
+struct ReleaseInfo {
+    std::string m_tagName;
+    std::vector<ReleaseAsset> m_assets;
+
+    static Result<ReleaseInfo> parse(std::string const& json);
+
+    /**
+     * First asset whose name contains the 
+     * given string & ends with the suffix, 
+     * or nullptr
+     */
+    ReleaseAsset const* findAsset(
+        std::string const& part,
+        std::string const& suffix = ""
+    ) const;
+};
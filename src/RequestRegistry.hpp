@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include "legacy/optional.hpp"
+#include <unordered_map>
+
+/**
+ * Handlers of live web requests by request ID. 
+ * Manager binds one handler per event type and 
+ * routes every event through here; the entry 
+ * of a request is removed once it finishes, so 
+ * the registry only grows with the number of 
+ * requests in flight. Doesn't know about wx, 
+ * the handlers are whatever the caller needs
+ */
+template<class Handlers>
+class RequestRegistry {
+protected:
+    std::unordered_map<int, Handlers> m_entries;
+    size_t m_totalCount = 0;
+
+public:
+    /**
+     * Register a newly created request
+     */
+    Handlers& add(int id) {
+        m_totalCount++;
+        return m_entries[id];
+    }
+    /**
+     * Handlers of the request, registering 
+     * it if it wasn't yet
+     */
+    Handlers& get(int id) {
+        return m_entries[id];
+    }
+    /**
+     * Where to route an event of the request, 
+     * or null if it has already finished or 
+     * isn't one of ours
+     */
+    Handlers* find(int id) {
+        auto it = m_entries.find(id);
+        return it != m_entries.end() ? &it->second : nullptr;
+    }
+    Handlers const* find(int id) const {
+        auto it = m_entries.find(id);
+        return it != m_entries.end() ? &it->second : nullptr;
+    }
+    bool contains(int id) const {
+        return m_entries.count(id);
+    }
+    /**
+     * Remove a finished request & hand back its 
+     * handlers, so that the last one can run 
+     * after the request is gone
+     */
+    tl::optional<Handlers> finish(int id) {
+        auto it = m_entries.find(id);
+        if (it == m_entries.end()) return tl::nullopt;
+        tl::optional<Handlers> handlers(std::move(it->second));
+        m_entries.erase(it);
+        return handlers;
+    }
+
+    /**
+     * Requests registered & not finished yet
+     */
+    size_t getActiveCount() const {
+        return m_entries.size();
+    }
+    /**
+     * Requests registered through add() ever
+     */
+    size_t getTotalCount() const {
+        return m_totalCount;
+    }
+
+    auto begin() {
+        return m_entries.begin();
+    }
+    auto end() {
+        return m_entries.end();
+    }
+};
@@ -0,0 +1,120 @@
+#include "RequestScheduler.hpp"
+#include <algorithm>
+
+static size_t index(RequestPriority priority) {
+    return static_cast<size_t>(priority);
+}
+
+void RequestScheduler::setMaxRunning(size_t max) {
+    m_maxRunning = std::max<size_t>(max, 1);
+}
+
+bool RequestScheduler::canStart(RequestPriority priority) const {
+    auto running = this->getRunningCount();
+    switch (priority) {
+        case RequestPriority::Interactive: return running < m_maxRunning;
+        // keep a slot free for interactive requests
+        case RequestPriority::Bulk: return running + 1 < std::max<size_t>(m_maxRunning, 2);
+        // only use bandwidth nothing else wants
+        case RequestPriority::Speculative: return
+            running == m_running[index(RequestPriority::Speculative)] &&
+            !m_queued[index(RequestPriority::Interactive)] &&
+            !m_queued[index(RequestPriority::Bulk)] &&
+            running < std::max<size_t>(m_maxRunning / 2, 1);
+    }
+    return false;
+}
+
+void RequestScheduler::enqueue(int id, RequestPriority priority) {
+    if (m_entries.count(id)) return;
+    m_entries[id].m_priority = priority;
+    m_queues[index(priority)].push_back(id);
+    m_queued[index(priority)]++;
+}
+
+void RequestScheduler::raisePriority(int id, RequestPriority priority) {
+    auto it = m_entries.find(id);
+    if (it == m_entries.end() || it->second.m_priority <= priority) return;
+    auto old = index(it->second.m_priority);
+    it->second.m_priority = priority;
+    if (it->second.m_started) {
+        m_running[old]--;
+        m_running[index(priority)]++;
+        return;
+    }
+    m_queued[old]--;
+    m_queued[index(priority)]++;
+    m_queues[index(priority)].push_back(id);
+}
+
+bool RequestScheduler::startNext(int& id) {
+    for (size_t i = 0; i < m_queues.size(); i++) {
+        auto priority = static_cast<RequestPriority>(i);
+        auto& queue = m_queues[i];
+        while (queue.size()) {
+            auto next = queue.front();
+            auto it = m_entries.find(next);
+            if (
+                it == m_entries.end() ||
+                it->second.m_started ||
+                it->second.m_priority != priority
+            ) {
+                queue.pop_front();
+                continue;
+            }
+            if (!this->canStart(priority)) break;
+            queue.pop_front();
+            it->second.m_started = true;
+            m_queued[i]--;
+            m_running[i]++;
+            id = next;
+            return true;
+        }
+    }
+    return false;
+}
+
+void RequestScheduler::finish(int id) {
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) return;
+    if (it->second.m_started) {
+        m_running[index(it->second.m_priority)]--;
+    } else {
+        m_queued[index(it->second.m_priority)]--;
+    }
+    m_entries.erase(it);
+}
+
+bool RequestScheduler::isTracked(int id) const {
+    return m_entries.count(id);
+}
+
+bool RequestScheduler::isStarted(int id) const {
+    auto it = m_entries.find(id);
+    return it != m_entries.end() && it->second.m_started;
+}
+
+RequestPriority RequestScheduler::getPriority(int id) const {
+    auto it = m_entries.find(id);
+    return it == m_entries.end() ? RequestPriority::Interactive : it->second.m_priority;
+}
+
+size_t RequestScheduler::getRunningCount() const {
+    size_t running = 0;
+    for (auto count : m_running) {
+        running += count;
+    }
+    return running;
+}
+
+size_t RequestScheduler::getQueuedCount() const {
+    size_t queued = 0;
+    for (auto count : m_queued) {
+        queued += count;
+    }
+    return queued;
+}
+
+size_t RequestScheduler::getTrackedCount() const {
+    return m_entries.size();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+
+enum class RequestPriority {
+    /**
+     * Small requests the user is waiting 
+     * on, like version checks
+     */
+    Interactive,
+    /**
+     * File downloads
+     */
+    Bulk,
+    /**
+     * Requests nobody is waiting on yet
+     */
+    Speculative,
+};
+
+/**
+ * Decides when web requests get to run. Requests 
+ * wait in a queue per priority & start while 
+ * there's a free slot for their priority; some 
+ * slots are always kept free for more important 
+ * requests than bulk & speculative ones. Only 
+ * deals in request IDs, so it's up to the 
+ * caller to actually start the requests
+ */
+class RequestScheduler {
+protected:
+    struct Entry {
+        RequestPriority m_priority;
+        bool m_started = false;
+    };
+    std::unordered_map<int, Entry> m_entries;
+    /**
+     * IDs of waiting requests. Finished & moved 
+     * requests are left in here & skipped once 
+     * they come up
+     */
+    std::array<std::deque<int>, 3> m_queues;
+    std::array<size_t, 3> m_queued {};
+    std::array<size_t, 3> m_running {};
+    size_t m_maxRunning = 1;
+
+public:
+    void setMaxRunning(size_t max);
+    bool canStart(RequestPriority priority) const;
+
+    void enqueue(int id, RequestPriority priority);
+    /**
+     * Move a request to a more important priority, 
+     * e.g. when someone starts waiting on a 
+     * speculative one. Lower priorities are ignored
+     */
+    void raisePriority(int id, RequestPriority priority);
+    /**
+     * Take the most important waiting request that 
+     * can start now & count it as running. Returns 
+     * false if there's none
+     */
+    bool startNext(int& id);
+    /**
+     * The request finished or was cancelled, 
+     * whether it got to start or not
+     */
+    void finish(int id);
+
+    bool isTracked(int id) const;
+    bool isStarted(int id) const;
+    RequestPriority getPriority(int id) const;
+    size_t getRunningCount() const;
+    size_t getQueuedCount() const;
+    /**
+     * Requests waiting or running
+     */
+    size_t getTrackedCount() const;
+};
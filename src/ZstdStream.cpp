@@ -0,0 +1,61 @@
+#include "ZstdStream.hpp"
+
+#ifdef GEODE_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+bool isZstdData(const void* data, size_t size) {
+    auto bytes = static_cast<const unsigned char*>(data);
+    return
+        size >= 4 &&
+        bytes[0] == 0x28 && bytes[1] == 0xb5 &&
+        bytes[2] == 0x2f && bytes[3] == 0xfd;
+}
+
+#ifdef GEODE_HAS_ZSTD
+
+ZstdInputStream::ZstdInputStream(wxInputStream& stream)
+  : wxFilterInputStream(stream),
+    m_context(ZSTD_createDStream()),
+    m_input(ZSTD_DStreamInSize()) {}
+
+ZstdInputStream::~ZstdInputStream() {
+    ZSTD_freeDStream(m_context);
+}
+
+size_t ZstdInputStream::OnSysRead(void* buffer, size_t size) {
+    if (!m_context) {
+        m_lasterror = wxSTREAM_READ_ERROR;
+        return 0;
+    }
+    ZSTD_outBuffer out = { buffer, size, 0 };
+    while (!out.pos) {
+        if (m_inputPos == m_inputSize && !m_pending) {
+            m_parent_i_stream->Read(m_input.data(), m_input.size());
+            m_inputSize = m_parent_i_stream->LastRead();
+            m_inputPos = 0;
+            if (!m_inputSize) {
+                // running out of data in the middle 
+                // of a frame means it was cut off
+                m_lasterror =
+                    m_frameEnded && m_parent_i_stream->Eof() ?
+                        wxSTREAM_EOF : wxSTREAM_READ_ERROR;
+                return 0;
+            }
+        }
+        ZSTD_inBuffer in = { m_input.data(), m_inputSize, m_inputPos };
+        auto ret = ZSTD_decompressStream(m_context, &out, &in);
+        if (ZSTD_isError(ret)) {
+            m_lasterror = wxSTREAM_READ_ERROR;
+            return 0;
+        }
+        m_inputPos = in.pos;
+        m_frameEnded = ret == 0;
+        // at the end of a frame everything has 
+        // been flushed already
+        m_pending = out.pos == out.size && !m_frameEnded;
+    }
+    return out.pos;
+}
+
+#endif
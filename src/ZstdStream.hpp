@@ -0,0 +1,40 @@
+#pragma once
+
+#include "include/wx.hpp"
+#include <wx/stream.h>
+#include <vector>
+
+/**
+ * Check for the magic number that starts 
+ * every Zstandard frame
+ */
+bool isZstdData(const void* data, size_t size);
+
+#ifdef GEODE_HAS_ZSTD
+
+struct ZSTD_DCtx_s;
+
+/**
+ * Decompresses a stream of one or more 
+ * Zstandard frames, like wxZlibInputStream 
+ * does for deflate
+ */
+class ZstdInputStream : public wxFilterInputStream {
+protected:
+    ZSTD_DCtx_s* m_context;
+    std::vector<char> m_input;
+    size_t m_inputPos = 0;
+    size_t m_inputSize = 0;
+    // the last call filled the output buffer, 
+    // so zstd may still be holding some back
+    bool m_pending = false;
+    bool m_frameEnded = true;
+
+    size_t OnSysRead(void* buffer, size_t size) override;
+
+public:
+    ZstdInputStream(wxInputStream& stream);
+    ~ZstdInputStream();
+};
+
+#endif
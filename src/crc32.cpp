@@ -0,0 +1,210 @@
+#include "include/CRC32.hpp"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CRC32_PCLMUL
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CRC32_TARGET
+#else
+#include <cpuid.h>
+#define CRC32_TARGET __attribute__((target("pclmul,sse4.1")))
+#endif
+#elif defined(__ARM_FEATURE_CRC32)
+#define CRC32_ARM
+#include <arm_acle.h>
+#endif
+
+// the folding kernel needs at least this 
+// many bytes to be worth setting up
+#define CRC32_MIN_FOLD_SIZE 64
+
+using CRC32Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+/**
+ * Table n gives the CRC of a byte followed by 
+ * n zero bytes, so 8 bytes can be looked up at 
+ * once (slicing-by-8)
+ */
+static CRC32Tables makeTables() {
+    CRC32Tables tables;
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (crc & 1 ? 0xedb88320 : 0);
+        }
+        tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (size_t t = 1; t < tables.size(); t++) {
+            auto prev = tables[t - 1][i];
+            tables[t][i] = tables[0][prev & 0xff] ^ (prev >> 8);
+        }
+    }
+    return tables;
+}
+
+static const CRC32Tables TABLES = makeTables();
+
+static uint32_t updateTables(uint32_t crc, const uint8_t* bytes, size_t size) {
+    while (size >= 8) {
+        auto low = crc ^ (
+            bytes[0] | bytes[1] << 8 |
+            bytes[2] << 16 | static_cast<uint32_t>(bytes[3]) << 24
+        );
+        crc =
+            TABLES[7][low & 0xff] ^
+            TABLES[6][(low >> 8) & 0xff] ^
+            TABLES[5][(low >> 16) & 0xff] ^
+            TABLES[4][low >> 24] ^
+            TABLES[3][bytes[4]] ^
+            TABLES[2][bytes[5]] ^
+            TABLES[1][bytes[6]] ^
+            TABLES[0][bytes[7]];
+        bytes += 8;
+        size -= 8;
+    }
+    while (size--) {
+        crc = TABLES[0][(crc ^ *bytes++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef CRC32_PCLMUL
+
+static bool hasPCLMUL() {
+    #ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    auto ecx = static_cast<unsigned>(info[2]);
+    #else
+    unsigned eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+    #endif
+    // PCLMULQDQ & SSE4.1
+    return (ecx & (1 << 1)) && (ecx & (1 << 19));
+}
+
+static const bool HAS_PCLMUL = hasPCLMUL();
+
+CRC32_TARGET static inline __m128i load(const uint8_t* bytes) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+}
+
+CRC32_TARGET static inline __m128i fold(__m128i x, __m128i k, __m128i next) {
+    auto low = _mm_clmulepi64_si128(x, k, 0x00);
+    auto high = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(high, low), next);
+}
+
+/**
+ * Folds 64 bytes at a time with carry-less 
+ * multiplication & reduces the result with 
+ * Barrett reduction, as described in Intel's 
+ * "Fast CRC Computation for Generic Polynomials 
+ * Using PCLMULQDQ". Size must be a multiple of 
+ * 16 and at least 64
+ */
+CRC32_TARGET static uint32_t updateFolded(uint32_t crc, const uint8_t* bytes, size_t size) {
+    auto k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+    auto k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+    auto k5k0 = _mm_set_epi64x(0x0000000000, 0x0163cd6124);
+    auto poly = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+
+    auto x1 = _mm_xor_si128(load(bytes), _mm_cvtsi32_si128(static_cast<int>(crc)));
+    auto x2 = load(bytes + 16);
+    auto x3 = load(bytes + 32);
+    auto x4 = load(bytes + 48);
+    bytes += 64;
+    size -= 64;
+
+    while (size >= 64) {
+        x1 = fold(x1, k1k2, load(bytes));
+        x2 = fold(x2, k1k2, load(bytes + 16));
+        x3 = fold(x3, k1k2, load(bytes + 32));
+        x4 = fold(x4, k1k2, load(bytes + 48));
+        bytes += 64;
+        size -= 64;
+    }
+
+    x1 = fold(x1, k3k4, x2);
+    x1 = fold(x1, k3k4, x3);
+    x1 = fold(x1, k3k4, x4);
+    while (size >= 16) {
+        x1 = fold(x1, k3k4, load(bytes));
+        bytes += 16;
+        size -= 16;
+    }
+
+    // 128 bits to 64
+    auto mask = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k5k0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), poly, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), poly, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+#endif
+
+void CRC32::update(const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    auto crc = m_crc;
+    #if defined(CRC32_PCLMUL)
+    if (HAS_PCLMUL && size >= CRC32_MIN_FOLD_SIZE) {
+        auto folded = size & ~static_cast<size_t>(15);
+        crc = updateFolded(crc, bytes, folded);
+        bytes += folded;
+        size -= folded;
+    }
+    #elif defined(CRC32_ARM)
+    // every ARMv8 Mac has the CRC32 instructions
+    for (; size >= 8; bytes += 8, size -= 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        crc = __crc32d(crc, word);
+    }
+    #endif
+    m_crc = updateTables(crc, bytes, size);
+}
+
+void CRC32::updatePortable(const void* data, size_t size) {
+    m_crc = updateTables(m_crc, static_cast<const uint8_t*>(data), size);
+}
+
+const char* CRC32::getKernel() {
+    #if defined(CRC32_PCLMUL)
+    return HAS_PCLMUL ? "pclmul" : "table";
+    #elif defined(CRC32_ARM)
+    return "armv8";
+    #else
+    return "table";
+    #endif
+}
+
+uint32_t CRC32::finish() const {
+    return m_crc ^ 0xffffffff;
+}
+
+uint32_t CRC32::hashFile(ghc::filesystem::path const& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return 0;
+
+    CRC32 crc;
+    std::vector<char> buffer(64 * 1024);
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        crc.update(buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+    return crc.finish();
+}
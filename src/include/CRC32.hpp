@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include "../legacy/filesystem.hpp"
+
+/**
+ * Incremental CRC-32 as used by zip 
+ * (polynomial 0xEDB88320)
+ */
+class CRC32 {
+protected:
+    uint32_t m_crc = 0xffffffff;
+
+public:
+    void update(const void* data, size_t size);
+    /**
+     * Same as update but always table-driven, 
+     * to check & time the hardware kernels 
+     * against
+     */
+    void updatePortable(const void* data, size_t size);
+    uint32_t finish() const;
+
+    /**
+     * Name of the kernel update uses on this 
+     * CPU: "pclmul", "armv8" or "table"
+     */
+    static const char* getKernel();
+
+    /**
+     * CRC of the whole file, or 0 if it 
+     * can't be read
+     */
+    static uint32_t hashFile(ghc::filesystem::path const& path);
+};
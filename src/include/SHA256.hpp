@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "../legacy/filesystem.hpp"
+
+/**
+ * Incremental SHA-256, so data can be hashed 
+ * piece by piece as it arrives
+ */
+class SHA256 {
+protected:
+    uint32_t m_state[8];
+    uint8_t m_buffer[64];
+    size_t m_bufferSize = 0;
+    uint64_t m_length = 0;
+
+    void transform(const uint8_t* block);
+
+public:
+    SHA256();
+
+    void update(const void* data, size_t size);
+    /**
+     * Finish hashing and return the digest as 
+     * a lowercase hex string. The object can't 
+     * be updated anymore after this
+     */
+    std::string finish();
+
+    static std::string hashFile(ghc::filesystem::path const& path);
+};
@@ -1,10 +1,19 @@
 #include "MainFrame.hpp"
 #include <wx/cmdline.h>
+#include <cstdio>
 #include "Manager.hpp"
+#include "FixtureServer.hpp"
 
 class GeodeInstallerApp : public wxApp {
+protected:
+    wxString m_benchDirectory;
+    int m_exitCode = 0;
+
+    void runFixtureBenchmark();
+
 public:
     virtual bool OnInit();
+    int OnRun() override;
 
     void OnInitCmdLine(wxCmdLineParser& parser) override;
     bool OnCmdLineParsed(wxCmdLineParser& parser) override;
@@ -14,6 +23,18 @@ static const wxCmdLineEntryDesc g_cmdLineDesc [] = {
     { wxCMD_LINE_SWITCH, "h", "help", "Displays help on the command line parameters",
         wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
     { wxCMD_LINE_OPTION, "u", "update", "Update loader" },
+    { wxCMD_LINE_OPTION, nullptr, "fixture-server",
+        "Serve downloads from a local directory laid out as <host>/<path>" },
+    { wxCMD_LINE_OPTION, nullptr, "fixture-latency",
+        "Delay of fixture server responses in ms", wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, nullptr, "fixture-bandwidth",
+        "Fixture server bandwidth in bytes per second", wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, nullptr, "fixture-errors",
+        "Fraction of fixture server requests that fail", wxCMD_LINE_VAL_DOUBLE },
+    { wxCMD_LINE_OPTION, nullptr, "fixture-drops",
+        "Fraction of fixture server responses cut off halfway", wxCMD_LINE_VAL_DOUBLE },
+    { wxCMD_LINE_OPTION, nullptr, "fixture-bench",
+        "Install from the fixture server into this scratch directory, print how long each stage took & exit" },
     { wxCMD_LINE_NONE },
 };
 
@@ -21,11 +42,54 @@ wxIMPLEMENT_APP(GeodeInstallerApp);
 
 bool GeodeInstallerApp::OnInit() {
     if (!wxApp::OnInit()) return false;
+    if (m_benchDirectory.size()) {
+        this->runFixtureBenchmark();
+        return true;
+    }
     auto frame = new MainFrame();
     frame->Show(true);
     return true;
 }
 
+int GeodeInstallerApp::OnRun() {
+    auto code = wxApp::OnRun();
+    return m_exitCode ? m_exitCode : code;
+}
+
+void GeodeInstallerApp::runFixtureBenchmark() {
+    auto manager = Manager::get();
+    manager->runFixtureBenchmark(
+        m_benchDirectory.ToStdWstring(),
+        [this](std::string const& error) -> void {
+            std::fprintf(stderr, "Fixture benchmark failed: %s\n", error.c_str());
+            m_exitCode = 1;
+            this->ExitMainLoop();
+        },
+        [this, manager]() -> void {
+            for (auto& stage : manager->getStageTimings()) {
+                std::printf("%-24s %8lld ms", stage.m_name.c_str(), stage.m_duration);
+                if (stage.m_bytes) {
+                    std::printf(
+                        "  %10s",
+                        DownloadTelemetry::formatSize(static_cast<double>(stage.m_bytes)).c_str()
+                    );
+                    if (stage.m_duration > 0) {
+                        std::printf("  %10s/s", DownloadTelemetry::formatSize(
+                            stage.m_bytes * 1000.0 / stage.m_duration
+                        ).c_str());
+                    }
+                }
+                if (stage.m_details.size()) {
+                    std::printf("  %s", stage.m_details.c_str());
+                }
+                std::printf("\n");
+            }
+            std::fflush(stdout);
+            this->ExitMainLoop();
+        }
+    );
+}
+
 void GeodeInstallerApp::OnInitCmdLine(wxCmdLineParser& parser) {
     parser.SetDesc(g_cmdLineDesc);
     parser.SetSwitchChars("-");
@@ -37,5 +101,30 @@ bool GeodeInstallerApp::OnCmdLineParsed(wxCmdLineParser& parser) {
         Manager::get()->m_mode = InstallerMode::UpdateLoader;
         Manager::get()->m_loaderUpdatePath = value.ToStdWstring();
     }
+    if (parser.Found("fixture-bench", &value)) {
+        m_benchDirectory = value;
+    }
+    if (parser.Found("fixture-server", &value)) {
+        FixtureServerOptions options;
+        long number;
+        double fraction;
+        if (parser.Found("fixture-latency", &number)) {
+            options.m_latency = number;
+        }
+        if (parser.Found("fixture-bandwidth", &number)) {
+            options.m_bandwidth = number;
+        }
+        if (parser.Found("fixture-errors", &fraction)) {
+            options.m_errorRate = fraction;
+        }
+        if (parser.Found("fixture-drops", &fraction)) {
+            options.m_dropRate = fraction;
+        }
+        auto res = Manager::get()->startFixtureServer(value.ToStdWstring(), options);
+        if (!res) {
+            wxMessageBox(res.error(), "Error starting fixture server", wxICON_ERROR);
+            return false;
+        }
+    }
     return true;
 }
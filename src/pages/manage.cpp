@@ -11,6 +11,12 @@ protected:
         m_frame->updateControls();
     }
 
+    void enter() override {
+        // the check page is usually answered 
+        // from the cache by the time it's up
+        Manager::get()->prefetchUpdateMetadata();
+    }
+
 public:
     PageManageSelect(MainFrame* frame) : Page(frame) {
         this->addText("Pick an installation to modify:");
@@ -129,6 +135,9 @@ protected:
                 }
             );
         }
+        // the check above took over the prefetch it 
+        // needs, the others aren't needed anymore
+        Manager::get()->cancelSpeculativeRequests();
     }
 
 public:
@@ -204,7 +213,7 @@ protected:
 
     void enter() override {
         if (GET_EARLIER_PAGE(ManageSelect)->updateCLI()) {
-            Manager::get()->downloadCLI(
+            Manager::get()->downloadAndInstallCLI(
                 [this](std::string const& str) -> void {
                     wxMessageBox(
                         "Error downloading the Geode CLI: " + str + 
@@ -215,26 +224,23 @@ protected:
                     );
                     this->setText(m_status, "Error: " + str);
                 },
+                [this](std::string const& str) -> void {
+                    wxMessageBox(
+                        "Error updating Geode CLI: " + str + ". Try "
+                        "again, and if the problem persists, contact "
+                        "the Geode Development team for more help.",
+                        "Error Updating",
+                        wxICON_ERROR
+                    );
+                    this->setText(m_status, "Error: " + str);
+                },
                 [this](std::string const& text, int prog) -> void {
                     this->setText(m_status, "Downloading Geode CLI: " + text);
                     m_gauge->SetValue(prog);
                 },
-                [this](wxWebResponse const& wres) -> void {
-                    auto installRes = Manager::get()->installCLI(
-                        wres.GetDataFile().ToStdWstring()
-                    );
-                    if (!installRes) {
-                        wxMessageBox(
-                            "Error updating Geode CLI: " + installRes.error() + ". Try "
-                            "again, and if the problem persists, contact "
-                            "the Geode Development team for more help.",
-                            "Error Updating",
-                            wxICON_ERROR
-                        );
-                    } else {
-                        Manager::get()->setCLIVersion(GET_EARLIER_PAGE(ManageCheck)->getCLIVersion());
-                        m_frame->nextPage();
-                    }
+                [this]() -> void {
+                    Manager::get()->setCLIVersion(GET_EARLIER_PAGE(ManageCheck)->getCLIVersion());
+                    m_frame->nextPage();
                 }
             );
         } else {
@@ -0,0 +1,56 @@
+#include "Allocations.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// keeps the size in front of every block 
+// so delete knows how much was freed
+#define ALLOCATION_HEADER alignof(std::max_align_t)
+
+static std::atomic<size_t> s_count;
+static std::atomic<size_t> s_bytes;
+static std::atomic<size_t> s_live;
+static std::atomic<size_t> s_peak;
+
+AllocationStats getAllocationStats() {
+    return { s_count.load(), s_bytes.load(), s_peak.load() };
+}
+
+void resetAllocationPeak() {
+    s_peak = s_live.load();
+}
+
+void* operator new(size_t size) {
+    auto block = static_cast<char*>(std::malloc(size + ALLOCATION_HEADER));
+    if (!block) throw std::bad_alloc();
+    *reinterpret_cast<size_t*>(block) = size;
+    s_count++;
+    s_bytes += size;
+    auto live = s_live += size;
+    auto peak = s_peak.load();
+    while (live > peak && !s_peak.compare_exchange_weak(peak, live));
+    return block + ALLOCATION_HEADER;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    auto block = static_cast<char*>(ptr) - ALLOCATION_HEADER;
+    s_live -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete[](void* ptr) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    ::operator delete(ptr);
+}
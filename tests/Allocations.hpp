@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Heap use of the test process, counted by 
+ * replacing the global operator new & delete, 
+ * for benchmarks that compare how much memory 
+ * two ways of doing something need
+ */
+struct AllocationStats {
+    size_t m_count;
+    size_t m_bytes;
+    /**
+     * Most bytes live at once since the last 
+     * resetAllocationPeak()
+     */
+    size_t m_peak;
+};
+
+AllocationStats getAllocationStats();
+
+/**
+ * Start measuring the peak from what's 
+ * currently allocated
+ */
+void resetAllocationPeak();
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+/**
+ * Minimal test registry. Test cases are plain 
+ * functions that throw TestFailure (through 
+ * CHECK) when something doesn't hold; the 
+ * runner picks them up by suite name
+ */
+struct TestCase {
+    const char* m_suite;
+    const char* m_name;
+    void(*m_func)();
+};
+
+std::vector<TestCase>& getTestCases();
+
+struct TestRegistrar {
+    inline TestRegistrar(const char* suite, const char* name, void(*func)()) {
+        getTestCases().push_back({ suite, name, func });
+    }
+};
+
+class TestFailure : public std::runtime_error {
+public:
+    inline TestFailure(const char* file, int line, std::string const& what)
+      : std::runtime_error(std::string(file) + ":" + std::to_string(line) + ": " + what) {}
+};
+
+/**
+ * Print a measurement (a count, a rate, ...) 
+ * next to the test results, so numbers like 
+ * syscalls per file show up in the CTest log
+ */
+void report(std::string const& name, double value, std::string const& unit);
+
+/**
+ * Empty directory for a test to write into, 
+ * removed again when the runner exits
+ */
+ghc::filesystem::path getTestDirectory(std::string const& name);
+
+#define TEST_CASE(suite, name) \
+    static void suite##_##name(); \
+    static TestRegistrar suite##_##name##_registrar(#suite, #name, &suite##_##name); \
+    static void suite##_##name()
+
+#define CHECK(...) do { \
+    if (!(__VA_ARGS__)) throw TestFailure(__FILE__, __LINE__, "CHECK(" #__VA_ARGS__ ") failed"); \
+} while (false)
+
+/**
+ * Check a Result and fail with its error
+ */
+#define CHECK_OK(...) do { \
+    auto _res = (__VA_ARGS__); \
+    if (!_res) throw TestFailure(__FILE__, __LINE__, #__VA_ARGS__ ": " + std::string(_res.error())); \
+} while (false)
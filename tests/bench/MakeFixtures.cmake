@@ -0,0 +1,97 @@
+# Writes fixture releases for the fixture server, 
+# laid out as <host>/<path> like mirror URLs:
+#   cmake -DFIXTURE_DIR=<dir> [-DFIXTURE_FILES=2000] [-DFIXTURE_LARGE_FILES=2] -P MakeFixtures.cmake
+# The CLI archive has many small files & a few 
+# large ones, like real CLI releases do
+cmake_minimum_required(VERSION 3.18)
+
+if (NOT FIXTURE_DIR)
+	message(FATAL_ERROR "Set FIXTURE_DIR to where the fixtures should go")
+endif()
+if (NOT FIXTURE_FILES)
+	set(FIXTURE_FILES 2000)
+endif()
+if (NOT FIXTURE_LARGE_FILES)
+	set(FIXTURE_LARGE_FILES 2)
+endif()
+set(FIXTURE_VERSION v9.9.9)
+
+file(REMOVE_RECURSE ${FIXTURE_DIR})
+set(WORK ${FIXTURE_DIR}/.work)
+set(CONTENT ${WORK}/cli)
+
+# many small files in nested directories
+string(RANDOM LENGTH 4096 SEED 1 SMALL_DATA)
+math(EXPR LAST "${FIXTURE_FILES} - 1")
+foreach(I RANGE ${LAST})
+	math(EXPR DIR "${I} % 40")
+	math(EXPR SUBDIR "${I} % 7")
+	file(WRITE ${CONTENT}/lib/dir${DIR}/sub${SUBDIR}/file${I}.txt "${I}\n${SMALL_DATA}")
+endforeach()
+
+# a few large ones, 8 MB each
+string(RANDOM LENGTH 65536 SEED 2 LARGE_CHUNK)
+string(REPEAT "${LARGE_CHUNK}" 128 LARGE_DATA)
+math(EXPR LAST "${FIXTURE_LARGE_FILES} - 1")
+foreach(I RANGE ${LAST})
+	file(WRITE ${CONTENT}/geode${I} "${I}${LARGE_DATA}")
+endforeach()
+
+set(RELEASE_HOST github.com/geode-sdk/cli/releases/download/${FIXTURE_VERSION})
+set(RELEASE_URL https://${RELEASE_HOST})
+set(ASSETS "")
+foreach(PLATFORM win mac)
+	set(NAME geode-cli-${FIXTURE_VERSION}-${PLATFORM}.zip)
+	set(ARCHIVE ${FIXTURE_DIR}/${RELEASE_HOST}/${NAME})
+	get_filename_component(ARCHIVE_DIR ${ARCHIVE} DIRECTORY)
+	file(MAKE_DIRECTORY ${ARCHIVE_DIR})
+	file(GLOB ENTRIES RELATIVE ${CONTENT} ${CONTENT}/*)
+	execute_process(
+		COMMAND ${CMAKE_COMMAND} -E tar cf ${ARCHIVE} --format=zip ${ENTRIES}
+		WORKING_DIRECTORY ${CONTENT}
+		RESULT_VARIABLE RESULT
+	)
+	if (NOT RESULT EQUAL 0)
+		message(FATAL_ERROR "Unable to create ${ARCHIVE}")
+	endif()
+	file(SHA256 ${ARCHIVE} DIGEST)
+	if (ASSETS)
+		string(APPEND ASSETS ",")
+	endif()
+	string(APPEND ASSETS "
+    {
+      \"name\": \"${NAME}\",
+      \"browser_download_url\": \"${RELEASE_URL}/${NAME}\",
+      \"digest\": \"sha256:${DIGEST}\"
+    }")
+endforeach()
+
+file(WRITE ${FIXTURE_DIR}/api.github.com/repos/geode-sdk/cli/releases/latest "{
+  \"tag_name\": \"${FIXTURE_VERSION}\",
+  \"assets\": [${ASSETS}
+  ]
+}
+")
+
+foreach(BRANCH main nightly)
+	file(WRITE ${FIXTURE_DIR}/raw.githubusercontent.com/geode-sdk/suite/${BRANCH}/versions.json "{
+  \"loader\": \"${FIXTURE_VERSION}\",
+  \"cli\": \"${FIXTURE_VERSION}\"
+}
+")
+endforeach()
+
+# geodeutils, with the digest next to it
+string(RANDOM LENGTH 262144 SEED 3 UTILS_DATA)
+foreach(LIB windows/geodeutils.dll macos/libgeodeutils.dylib)
+	foreach(BRANCH main nightly)
+		set(PATH ${FIXTURE_DIR}/github.com/geode-sdk/suite/raw/${BRANCH}/${LIB})
+		file(WRITE ${PATH} "${UTILS_DATA}")
+		file(SHA256 ${PATH} DIGEST)
+		get_filename_component(NAME ${LIB} NAME)
+		file(WRITE ${PATH}.sha256 "${DIGEST}  ${NAME}\n")
+	endforeach()
+endforeach()
+
+file(REMOVE_RECURSE ${WORK})
+message(STATUS "Wrote fixtures to ${FIXTURE_DIR}")
@@ -0,0 +1,109 @@
+#include "../Test.hpp"
+#include "include/CRC32.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#define CRC_MAX_LENGTH 3000
+// the kernels load 16 bytes at a time, so 
+// every offset into that has to work
+#define CRC_ALIGNMENTS 7
+#define CRC_BENCH_SIZE (32 * 1024 * 1024)
+#define CRC_BENCH_RUNS 4
+
+// one bit at a time, straight from the definition
+static uint32_t referenceCRC(const uint8_t* bytes, size_t size) {
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (crc & 1 ? 0xedb88320 : 0);
+        }
+    }
+    return crc ^ 0xffffffff;
+}
+
+static std::vector<uint8_t> makeData(size_t size, unsigned seed) {
+    std::mt19937 random(seed);
+    std::vector<uint8_t> data(size);
+    for (auto& byte : data) {
+        byte = static_cast<uint8_t>(random());
+    }
+    return data;
+}
+
+TEST_CASE(CRC32, knownValues) {
+    CRC32 empty;
+    CHECK(empty.finish() == 0);
+    CRC32 crc;
+    crc.update("123456789", 9);
+    CHECK(crc.finish() == 0xcbf43926);
+    std::printf("    kernel: %s\n", CRC32::getKernel());
+}
+
+TEST_CASE(CRC32, matchesReferenceAtEveryAlignment) {
+    auto data = makeData(CRC_MAX_LENGTH + CRC_ALIGNMENTS, 1);
+    for (size_t align = 0; align < CRC_ALIGNMENTS; align++) {
+        auto bytes = data.data() + align;
+        for (size_t size = 0; size <= CRC_MAX_LENGTH; size++) {
+            auto expected = referenceCRC(bytes, size);
+            CRC32 crc;
+            crc.update(bytes, size);
+            CHECK(crc.finish() == expected);
+            CRC32 portable;
+            portable.updatePortable(bytes, size);
+            CHECK(portable.finish() == expected);
+        }
+    }
+}
+
+TEST_CASE(CRC32, matchesReferenceInPieces) {
+    // inflating hands the CRC whatever the 
+    // decompressor produced, in any sizes
+    auto data = makeData(CRC_MAX_LENGTH, 2);
+    auto expected = referenceCRC(data.data(), data.size());
+    std::mt19937 random(3);
+    for (size_t run = 0; run < 500; run++) {
+        CRC32 crc;
+        size_t pos = 0;
+        while (pos < data.size()) {
+            auto size = std::min<size_t>(random() % 300, data.size() - pos);
+            crc.update(data.data() + pos, size);
+            pos += size;
+        }
+        CHECK(crc.finish() == expected);
+    }
+}
+
+TEST_CASE(CRC32, benchmarkKernels) {
+    auto data = makeData(CRC_BENCH_SIZE, 4);
+    auto measure = [&](auto func) {
+        auto start = std::chrono::steady_clock::now();
+        uint32_t result = 0;
+        for (size_t i = 0; i < CRC_BENCH_RUNS; i++) {
+            CRC32 crc;
+            func(crc);
+            result ^= crc.finish();
+        }
+        auto seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        return std::make_pair(
+            CRC_BENCH_SIZE * static_cast<double>(CRC_BENCH_RUNS) / seconds / (1024 * 1024),
+            result
+        );
+    };
+    auto [table, tableResult] = measure([&](CRC32& crc) {
+        crc.updatePortable(data.data(), data.size());
+    });
+    auto [kernel, kernelResult] = measure([&](CRC32& crc) {
+        crc.update(data.data(), data.size());
+    });
+    CHECK(tableResult == kernelResult);
+    std::printf("    kernel: %s\n", CRC32::getKernel());
+    report("slicing-by-8 table", table, "MB/s");
+    report("kernel", kernel, "MB/s");
+    report("speedup", kernel / table, "x");
+}
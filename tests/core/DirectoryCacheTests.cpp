@@ -0,0 +1,100 @@
+#include "../Test.hpp"
+#include "DirectoryCache.hpp"
+#include <set>
+
+#define DEEP_FILES 2000
+#define DEEP_LEVELS 8
+
+/**
+ * Counts the directories asked for; on disk 
+ * each is one mkdir that doubles as the check 
+ * whether it's there
+ */
+class CountingTarget : public DiskTarget {
+public:
+    size_t m_directories = 0;
+
+    Result<> createDirectory(ghc::filesystem::path const& path, bool parents) override {
+        m_directories++;
+        return DiskTarget::createDirectory(path, parents);
+    }
+};
+
+// 40 directories 8 levels down, like a/b/a/a/..., 
+// sharing the start of their paths
+static std::string deepName(size_t index) {
+    std::string name;
+    auto n = index % 40;
+    for (size_t level = 0; level < DEEP_LEVELS; level++) {
+        name += static_cast<char>('a' + n % 3);
+        name += "/";
+        n /= 3;
+    }
+    return name + "file" + std::to_string(index) + ".txt";
+}
+
+TEST_CASE(DirectoryCache, createsEachDirectoryOnce) {
+    MemoryTarget target;
+    DirectoryCache dirs(target, "root");
+    auto file = dirs.getFile("a/b/c.txt");
+    CHECK_OK(file);
+    CHECK(file.value() == ghc::filesystem::path("root") / "a" / "b" / "c.txt");
+    CHECK(target.hasDirectory(ghc::filesystem::path("root") / "a" / "b"));
+    CHECK(dirs.getCreatedCount() == 3);
+
+    CHECK_OK(dirs.getFile("a/b/d.txt"));
+    CHECK_OK(dirs.getDirectory("a/b/"));
+    CHECK_OK(dirs.getFile("top.txt"));
+    CHECK(dirs.getCreatedCount() == 3);
+    CHECK_OK(dirs.getFile("a/e/f.txt"));
+    CHECK(dirs.getCreatedCount() == 4);
+}
+
+TEST_CASE(DirectoryCache, statsOnDeepArchive) {
+    auto root = getTestDirectory("DirectoryCache-deep");
+    std::set<std::string> unique;
+    for (size_t i = 0; i < DEEP_FILES; i++) {
+        auto name = deepName(i);
+        for (auto slash = name.find('/'); slash != std::string::npos; slash = name.find('/', slash + 1)) {
+            unique.insert(name.substr(0, slash));
+        }
+    }
+
+    // before: every entry checked that its directory 
+    // exists, and if not, wxFileName::Mkdir checked 
+    // each part of the full path on the way down
+    size_t before = 0;
+    auto exists = [&](ghc::filesystem::path const& path) {
+        before++;
+        return ghc::filesystem::is_directory(path);
+    };
+    auto old = root / "before";
+    for (size_t i = 0; i < DEEP_FILES; i++) {
+        auto parent = (old / deepName(i)).parent_path();
+        if (exists(parent)) continue;
+        ghc::filesystem::path part;
+        for (auto& component : parent) {
+            part /= component;
+            if (!exists(part)) {
+                ghc::filesystem::create_directory(part);
+            }
+        }
+    }
+
+    CountingTarget target;
+    DirectoryCache dirs(target, root / "after");
+    for (size_t i = 0; i < DEEP_FILES; i++) {
+        auto file = dirs.getFile(deepName(i));
+        CHECK_OK(file);
+        CHECK(ghc::filesystem::is_directory(file.value().parent_path()));
+    }
+    // the root & every directory in the archive
+    CHECK(target.m_directories == unique.size() + 1);
+    CHECK(dirs.getCreatedCount() == unique.size() + 1);
+
+    report("files", static_cast<double>(DEEP_FILES), "");
+    report("directories", static_cast<double>(unique.size()), "");
+    report("directory checks before", static_cast<double>(before), "");
+    report("directory calls after", static_cast<double>(target.m_directories), "");
+    CHECK(target.m_directories < before);
+}
@@ -0,0 +1,123 @@
+#include "../Test.hpp"
+#include "DownloadCache.hpp"
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+#define ASSET_URL "https://github.com/geode-sdk/cli/releases/download/v1.0.0/geode-cli-v1.0.0-win.zip"
+#define OTHER_ASSET_URL "https://github.com/geode-sdk/cli/releases/download/v1.0.1/geode-cli-v1.0.1-win.zip"
+#define RAW_URL "https://raw.githubusercontent.com/geode-sdk/suite/main/versions.json"
+
+static ghc::filesystem::path writeDownload(
+    ghc::filesystem::path const& dir,
+    std::string const& name,
+    std::string const& data
+) {
+    auto path = dir / name;
+    std::ofstream(path.string(), std::ios::binary) << data;
+    return path;
+}
+
+// entries are ordered by their last use in 
+// milliseconds, so keep them apart
+static void nextMillisecond() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+}
+
+TEST_CASE(DownloadCache, countsHitsAndMisses) {
+    auto dir = getTestDirectory("DownloadCache-counts");
+    DownloadCache cache(dir / "cache", 1024 * 1024);
+    CHECK(!cache.get(ASSET_URL));
+    CHECK(!cache.find(ASSET_URL));
+
+    auto stored = cache.store(ASSET_URL, "\"a\"", "", writeDownload(dir, "a", "release"));
+    CHECK_OK(stored);
+    CHECK(cache.getMisses() == 1);
+    CHECK(!ghc::filesystem::exists(dir / "a"));
+
+    auto hit = cache.get(ASSET_URL);
+    CHECK(hit && *hit == stored.value());
+    CHECK(cache.getHits() == 1);
+
+    // mutable URLs need the server to say 
+    // they're still current first
+    CHECK_OK(cache.store(RAW_URL, "\"b\"", "", writeDownload(dir, "b", "versions")));
+    CHECK(!cache.get(RAW_URL));
+    CHECK(cache.find(RAW_URL) && cache.find(RAW_URL)->m_etag == "\"b\"");
+    CHECK(cache.revalidated(RAW_URL));
+    CHECK(cache.getHits() == 2);
+    CHECK(cache.getMisses() == 2);
+
+    // the counters & entries survive a restart
+    DownloadCache loaded(dir / "cache", 1024 * 1024);
+    CHECK_OK(loaded.load());
+    CHECK(loaded.getHits() == 2);
+    CHECK(loaded.getMisses() == 2);
+    CHECK(loaded.get(ASSET_URL));
+}
+
+TEST_CASE(DownloadCache, keepsBlobWhenStoredAgain) {
+    auto dir = getTestDirectory("DownloadCache-again");
+    DownloadCache cache(dir / "cache", 1024 * 1024);
+    CHECK_OK(cache.store(RAW_URL, "\"a\"", "", writeDownload(dir, "first", "same")));
+    // a 200 instead of a 304 for unchanged content
+    auto again = cache.store(RAW_URL, "\"a\"", "", writeDownload(dir, "second", "same"));
+    CHECK_OK(again);
+    CHECK(ghc::filesystem::exists(again.value()));
+    CHECK(cache.revalidated(RAW_URL));
+    CHECK(cache.getSize() == 4);
+
+    // changed content replaces the old blob
+    auto changed = cache.store(RAW_URL, "\"b\"", "", writeDownload(dir, "third", "changed"));
+    CHECK_OK(changed);
+    CHECK(!ghc::filesystem::exists(again.value()));
+    CHECK(ghc::filesystem::exists(changed.value()));
+}
+
+TEST_CASE(DownloadCache, sharesBlobsBetweenURLs) {
+    auto dir = getTestDirectory("DownloadCache-shared");
+    DownloadCache cache(dir / "cache", 1024 * 1024);
+    auto first = cache.store(ASSET_URL, "", "", writeDownload(dir, "a", "identical"));
+    auto second = cache.store(OTHER_ASSET_URL, "", "", writeDownload(dir, "b", "identical"));
+    CHECK_OK(first);
+    CHECK_OK(second);
+    CHECK(first.value() == second.value());
+    CHECK(cache.getSize() == 9);
+
+    // replacing one URL keeps the blob the 
+    // other still points to
+    CHECK_OK(cache.store(ASSET_URL, "", "", writeDownload(dir, "c", "different")));
+    CHECK(ghc::filesystem::exists(second.value()));
+    auto hit = cache.get(OTHER_ASSET_URL);
+    CHECK(hit && *hit == second.value());
+    CHECK(cache.getSize() == 18);
+}
+
+TEST_CASE(DownloadCache, evictsLeastRecentlyUsed) {
+    auto dir = getTestDirectory("DownloadCache-evict");
+    DownloadCache cache(dir / "cache", 250);
+    std::string data(100, 'x');
+    auto first = cache.store(ASSET_URL, "", "", writeDownload(dir, "a", data + "1"));
+    nextMillisecond();
+    auto second = cache.store(OTHER_ASSET_URL, "", "", writeDownload(dir, "b", data + "2"));
+    nextMillisecond();
+    CHECK_OK(first);
+    CHECK_OK(second);
+    // using the first makes the second the oldest
+    CHECK(cache.get(ASSET_URL));
+    nextMillisecond();
+
+    auto third = cache.store(RAW_URL, "", "", writeDownload(dir, "c", data + "3"));
+    CHECK_OK(third);
+    CHECK(cache.getSize() <= 250);
+    CHECK(cache.find(ASSET_URL));
+    CHECK(!cache.find(OTHER_ASSET_URL));
+    CHECK(!ghc::filesystem::exists(second.value()));
+    CHECK(cache.find(RAW_URL));
+
+    // shrinking the limit evicts right away
+    cache.setMaxSize(150);
+    CHECK(cache.getSize() <= 150);
+    CHECK(!cache.find(ASSET_URL));
+    CHECK(cache.find(RAW_URL));
+}
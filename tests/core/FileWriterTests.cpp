@@ -0,0 +1,151 @@
+#include "../Test.hpp"
+#include "FileWriter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#define SYSCALL_ENTRIES 3000
+// what extraction hands the writer at once
+#define EXTRACT_CHUNK 0x10000
+// what wxInputStream::Read(wxOutputStream&) 
+// passed on to wxFileOutputStream at once, 
+// which wrote each one straight out
+#define STREAM_CHUNK 4096
+
+static std::string readFile(ghc::filesystem::path const& path) {
+    std::ifstream file(path.string(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static std::string makeData(std::mt19937& random, size_t size) {
+    std::string data(size, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(random());
+    }
+    return data;
+}
+
+TEST_CASE(FileWriter, twoWritersOnOneThread) {
+    auto dir = getTestDirectory("FileWriter-two");
+    std::mt19937 random(1);
+    auto a = makeData(random, 300 * 1024);
+    auto b = makeData(random, 300 * 1024);
+
+    // buffers used to be per thread, so these 
+    // would have written over each other's data
+    FileWriter first, second;
+    CHECK_OK(first.open(dir / "a", a.size()));
+    CHECK_OK(second.open(dir / "b", b.size()));
+    for (size_t i = 0; i < a.size(); i += 1000) {
+        CHECK_OK(first.write(a.data() + i, std::min<size_t>(1000, a.size() - i)));
+        CHECK_OK(second.write(b.data() + i, std::min<size_t>(1000, b.size() - i)));
+    }
+    CHECK(first.getWritten() == a.size());
+    CHECK_OK(first.close());
+    CHECK_OK(second.close());
+    CHECK(readFile(dir / "a") == a);
+    CHECK(readFile(dir / "b") == b);
+}
+
+TEST_CASE(FileWriter, trimsPreallocatedFiles) {
+    auto dir = getTestDirectory("FileWriter-trim");
+    std::mt19937 random(2);
+    auto data = makeData(random, 100 * 1024);
+
+    // the archive claimed more than there was
+    FileWriter writer;
+    CHECK_OK(writer.open(dir / "short", 4 * 1024 * 1024));
+    CHECK_OK(writer.write(data.data(), data.size()));
+    CHECK_OK(writer.close());
+    CHECK(ghc::filesystem::file_size(dir / "short") == data.size());
+    CHECK(readFile(dir / "short") == data);
+    CHECK(!writer.write(data.data(), 1));
+}
+
+TEST_CASE(FileWriter, writesWholeFilesWithoutCopying) {
+    auto dir = getTestDirectory("FileWriter-whole");
+    std::mt19937 random(4);
+    auto data = makeData(random, 300 * 1024);
+
+    // like a stored entry straight from a mapping
+    FileWriter::resetStats();
+    FileWriter whole;
+    CHECK_OK(whole.open(dir / "whole", data.size()));
+    CHECK_OK(whole.write(data.data(), data.size()));
+    CHECK_OK(whole.close());
+    CHECK(FileWriter::getStats().m_bufferedBytes == 0);
+    CHECK(FileWriter::getStats().m_writes == 1);
+    CHECK(readFile(dir / "whole") == data);
+
+    // pieces are still gathered up first
+    FileWriter::resetStats();
+    FileWriter pieces;
+    CHECK_OK(pieces.open(dir / "pieces", data.size()));
+    CHECK_OK(pieces.write(data.data(), 1000));
+    CHECK_OK(pieces.write(data.data() + 1000, data.size() - 1000));
+    CHECK_OK(pieces.close());
+    CHECK(FileWriter::getStats().m_bufferedBytes == data.size());
+    CHECK(FileWriter::getStats().m_writes == 1);
+    CHECK(readFile(dir / "pieces") == data);
+}
+
+TEST_CASE(FileWriter, syscallsPerFile) {
+    auto dir = getTestDirectory("FileWriter-syscalls");
+    std::mt19937 random(3);
+    // mostly small files with a few big ones, 
+    // like the CLI & its resources
+    std::vector<size_t> sizes;
+    size_t total = 0;
+    for (size_t i = 0; i < SYSCALL_ENTRIES; i++) {
+        auto size = i % 500 == 0 ?
+            4 * 1024 * 1024 + random() % 1024 :
+            static_cast<size_t>(std::exp2(7 + random() % 1000 / 100.0));
+        sizes.push_back(size);
+        total += size;
+    }
+    auto data = makeData(random, *std::max_element(sizes.begin(), sizes.end()));
+
+    // before: every entry got its own unbuffered 
+    // stream that wrote each small chunk out
+    size_t before = 0;
+    for (size_t i = 0; i < sizes.size(); i++) {
+        auto path = dir / ("before-" + std::to_string(i));
+        auto file = std::fopen(path.string().c_str(), "wb");
+        CHECK(file);
+        std::setvbuf(file, nullptr, _IONBF, 0);
+        before++;
+        for (size_t pos = 0; pos < sizes[i]; pos += STREAM_CHUNK) {
+            auto chunk = std::min<size_t>(STREAM_CHUNK, sizes[i] - pos);
+            CHECK(std::fwrite(data.data() + pos, 1, chunk, file) == chunk);
+            before++;
+        }
+        std::fclose(file);
+        before++;
+    }
+
+    FileWriter::resetStats();
+    for (size_t i = 0; i < sizes.size(); i++) {
+        FileWriter writer;
+        CHECK_OK(writer.open(dir / ("after-" + std::to_string(i)), sizes[i]));
+        for (size_t pos = 0; pos < sizes[i]; pos += EXTRACT_CHUNK) {
+            CHECK_OK(writer.write(data.data() + pos, std::min<size_t>(EXTRACT_CHUNK, sizes[i] - pos)));
+        }
+        CHECK_OK(writer.close());
+    }
+    auto stats = FileWriter::getStats();
+    CHECK(stats.m_files == SYSCALL_ENTRIES);
+    CHECK(stats.m_closes == SYSCALL_ENTRIES);
+    CHECK(stats.m_bytes == total);
+    CHECK(readFile(dir / "after-500") == data.substr(0, sizes[500]));
+
+    auto after = stats.getSyscalls();
+    report("files", static_cast<double>(SYSCALL_ENTRIES), "");
+    report("syscalls per file before", static_cast<double>(before) / SYSCALL_ENTRIES, "");
+    report("syscalls per file after", static_cast<double>(after) / SYSCALL_ENTRIES, "");
+    report("writes per file after", static_cast<double>(stats.m_writes) / SYSCALL_ENTRIES, "");
+    report("preallocated files", static_cast<double>(stats.m_preallocations), "");
+    CHECK(after < before);
+}
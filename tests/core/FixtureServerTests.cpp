@@ -0,0 +1,72 @@
+#include "../Test.hpp"
+#include "FixtureServer.hpp"
+#include <fstream>
+
+TEST_CASE(FixtureServer, servesFixtureDirectory) {
+    auto dir = getTestDirectory("fixtures") / "root";
+    ghc::filesystem::create_directories(dir / "github.com" / "geode-sdk");
+    {
+        std::ofstream ofs(dir / "github.com" / "geode-sdk" / "cli.zip", std::ios::binary);
+        ofs << "0123456789";
+    }
+    {
+        std::ofstream ofs(dir.parent_path() / "secret.txt", std::ios::binary);
+        ofs << "secret";
+    }
+    FixtureServer server(dir, FixtureServerOptions());
+    CHECK_OK(server.start());
+
+    auto res = fixtureGet(server.getPort(), {}, 0, "/github.com/geode-sdk/cli.zip?raw=1");
+    CHECK_OK(res);
+    auto full = res.value();
+    CHECK(full.m_status == 200 && full.m_complete);
+    CHECK(full.m_body == "0123456789");
+    auto etag = full.m_headers["etag"];
+    CHECK(etag.size());
+
+    auto ranged = fixtureGet(
+        server.getPort(), { { "Range", "bytes=2-4" }, { "If-Range", etag } },
+        0, "/github.com/geode-sdk/cli.zip"
+    );
+    CHECK_OK(ranged);
+    CHECK(ranged.value().m_status == 206);
+    CHECK(ranged.value().m_body == "234");
+
+    auto unchanged = fixtureGet(
+        server.getPort(), { { "If-None-Match", etag } }, 0, "/github.com/geode-sdk/cli.zip"
+    );
+    CHECK_OK(unchanged);
+    CHECK(unchanged.value().m_status == 304);
+
+    // nothing outside of the directory is served
+    auto missing = fixtureGet(server.getPort(), {}, 0, "/github.com/geode-sdk/other.zip");
+    CHECK_OK(missing);
+    CHECK(missing.value().m_status == 404);
+    auto escaped = fixtureGet(server.getPort(), {}, 0, "/../secret.txt");
+    CHECK_OK(escaped);
+    CHECK(escaped.value().m_status == 404);
+
+    CHECK(server.getRequestCount() == 5);
+}
+
+TEST_CASE(FixtureServer, failsOnPurpose) {
+    FixtureServerOptions options;
+    options.m_errorRate = 1.0;
+    FixtureServer failing(options);
+    failing.setFile("data", "\"v1\"");
+    CHECK_OK(failing.start());
+    auto res = fixtureGet(failing.getPort());
+    CHECK_OK(res);
+    CHECK(res.value().m_status == 500);
+
+    options.m_errorRate = 0.0;
+    options.m_dropRate = 1.0;
+    FixtureServer dropping(options);
+    dropping.setFile(std::string(1000, 'd'), "\"v1\"");
+    CHECK_OK(dropping.start());
+    auto dropped = fixtureGet(dropping.getPort());
+    CHECK_OK(dropped);
+    CHECK(dropped.value().m_status == 200);
+    CHECK(!dropped.value().m_complete);
+    CHECK(dropped.value().m_body.size() == 500);
+}
@@ -0,0 +1,180 @@
+#include "../Test.hpp"
+#include "FixtureServer.hpp"
+#include "MirrorList.hpp"
+
+#define MIRROR_FILE_SIZE (256 * 1024)
+// in ms, how long a request may go without 
+// data before it counts as stalled
+#define MIRROR_STALL_TIMEOUT 300
+
+static std::string base(FixtureServer const& server) {
+    return "http://127.0.0.1:" + std::to_string(server.getPort());
+}
+
+/**
+ * Telemetry of a finished request to the given 
+ * URL, as Manager would have measured it
+ */
+static DownloadTelemetry measured(
+    std::string const& url,
+    int status,
+    long long latency,
+    double rate
+) {
+    DownloadTelemetry telemetry;
+    telemetry.start(url);
+    telemetry.dispatched();
+    telemetry.finish(status, false);
+    telemetry.m_firstByte = latency;
+    telemetry.m_bytesReceived = MIRROR_FILE_SIZE;
+    telemetry.m_averageRate = rate;
+    return telemetry;
+}
+
+/**
+ * Download the file from whichever server the 
+ * list ranks first & report how it went, the 
+ * way Manager does with its stall timer. 
+ * Returns the port the request went to
+ */
+static unsigned short fetch(MirrorList& mirrors, std::string const& url) {
+    auto resolved = mirrors.resolve(url);
+    unsigned short port = 0;
+    CHECK(std::sscanf(resolved.c_str(), "http://127.0.0.1:%hu/", &port) == 1);
+
+    DownloadTelemetry telemetry;
+    telemetry.start(resolved);
+    telemetry.dispatched();
+    auto res = fixtureGet(port, {}, MIRROR_STALL_TIMEOUT);
+    CHECK_OK(res);
+    auto response = res.value();
+    telemetry.received(
+        static_cast<long long>(response.m_body.size()),
+        std::stoll(response.m_headers["content-length"])
+    );
+    if (response.m_timedOut) {
+        telemetry.stalled();
+        telemetry.finish(response.m_status, true, true);
+    } else {
+        telemetry.finish(response.m_status, !response.m_complete);
+    }
+    mirrors.report(telemetry);
+    return port;
+}
+
+TEST_CASE(MirrorList, ranksByMeasuredSpeed) {
+    MirrorList mirrors({ "http://a.test", "http://b.test/" });
+    auto url = "https://github.com/geode-sdk/geode/releases/latest";
+
+    // unmeasured mirrors are tried in order
+    CHECK(mirrors.resolve(url) == "http://a.test/github.com/geode-sdk/geode/releases/latest");
+
+    mirrors.report(measured("http://a.test/x", 200, 400, 1024.0 * 1024));
+    mirrors.report(measured("http://b.test/x", 200, 50, 8.0 * 1024 * 1024));
+    // the origin hasn't been measured yet
+    CHECK(mirrors.resolve(url) == url);
+
+    mirrors.report(measured(url, 200, 200, 2.0 * 1024 * 1024));
+    CHECK(mirrors.resolve(url) == "http://b.test/github.com/geode-sdk/geode/releases/latest");
+    auto ranked = mirrors.getRanked();
+    CHECK(ranked.size() == 3);
+    CHECK(ranked[0].m_base == "http://b.test");
+    CHECK(ranked[1].isOrigin());
+    CHECK(ranked[2].m_base == "http://a.test");
+
+    // a mirror without the file is as 
+    // good as one that's down
+    mirrors.report(measured("http://b.test/x", 404, 50, 0.0));
+    CHECK(mirrors.getRanked().front().isOrigin());
+    // a successful request clears the failures
+    mirrors.report(measured("http://b.test/x", 200, 50, 8.0 * 1024 * 1024));
+    CHECK(mirrors.getRanked().front().m_base == "http://b.test");
+
+    // already rewritten URLs are left alone
+    CHECK(mirrors.resolve("http://a.test/github.com/x") == "http://a.test/github.com/x");
+}
+
+TEST_CASE(MirrorList, ignoresCancelledRequests) {
+    MirrorList mirrors({ "http://a.test" });
+    mirrors.report(measured("http://a.test/x", 200, 50, 8.0 * 1024 * 1024));
+    mirrors.report(measured("https://github.com/x", 200, 200, 1024.0 * 1024));
+
+    // cancelled by the installer, e.g. a speculative 
+    // request or a segment of a failed download
+    DownloadTelemetry cancelled;
+    cancelled.start("http://a.test/x");
+    cancelled.dispatched();
+    cancelled.finish(0, true, true);
+    for (int i = 0; i < 10; i++) {
+        mirrors.report(cancelled);
+    }
+    CHECK(mirrors.getMirrors().front().m_failures == 0);
+    CHECK(mirrors.getRanked().front().m_base == "http://a.test");
+
+    // cancelled because it stalled
+    DownloadTelemetry stalled;
+    stalled.start("http://a.test/x");
+    stalled.dispatched();
+    stalled.stalled();
+    stalled.finish(0, true, true);
+    mirrors.report(stalled);
+    CHECK(mirrors.getMirrors().front().m_failures == 1);
+    CHECK(mirrors.getRanked().front().isOrigin());
+}
+
+TEST_CASE(MirrorList, failsOverFromStalledMirror) {
+    std::string file(MIRROR_FILE_SIZE, 'm');
+    FixtureServer slow;
+    FixtureServer fast;
+    slow.setFile(file, "\"v1\"");
+    fast.setFile(file, "\"v1\"");
+    CHECK_OK(slow.start());
+    CHECK_OK(fast.start());
+
+    MirrorList mirrors({ base(slow), base(fast) });
+    auto url = "https://github.com/geode-sdk/geode/releases/download/v1/geode.zip";
+    // the first mirror has been the fastest 
+    // so far & the origin the slowest
+    mirrors.report(measured(base(slow) + "/x", 200, 10, 16.0 * 1024 * 1024));
+    mirrors.report(measured(base(fast) + "/x", 200, 100, 2.0 * 1024 * 1024));
+    mirrors.report(measured(url, 200, 2000, 64.0 * 1024));
+
+    CHECK(fetch(mirrors, url) == slow.getPort());
+    CHECK(mirrors.getMirrors()[0].m_failures == 0);
+
+    slow.stallNextAfter(MIRROR_FILE_SIZE / 4);
+    CHECK(fetch(mirrors, url) == slow.getPort());
+    CHECK(mirrors.getMirrors()[0].m_failures == 1);
+
+    // the stalled mirror is skipped from now on
+    CHECK(fetch(mirrors, url) == fast.getPort());
+    CHECK(fetch(mirrors, url) == fast.getPort());
+    CHECK(mirrors.getMirrors()[1].m_failures == 0);
+    CHECK(mirrors.getRanked().front().m_base == base(fast));
+}
+
+TEST_CASE(MirrorList, neverLeavesFixtureServer) {
+    FixtureServerOptions options;
+    options.m_errorRate = 1.0;
+    FixtureServer server(options);
+    server.setFile("data", "\"v1\"");
+    CHECK_OK(server.start());
+
+    // fixture mode with --fixture-errors
+    MirrorList mirrors({ "http://a.test" });
+    mirrors.useOnly(base(server) + "/");
+    auto url = "https://github.com/geode-sdk/geode/releases/latest";
+    CHECK(mirrors.getMirrors().size() == 1);
+    CHECK(mirrors.resolve(url) == base(server) + "/github.com/geode-sdk/geode/releases/latest");
+
+    // failures would otherwise make the 
+    // origin look better than the server
+    for (int i = 0; i < 5; i++) {
+        CHECK(fetch(mirrors, url) == server.getPort());
+    }
+    CHECK(mirrors.getMirrors().front().m_failures == 5);
+    CHECK(mirrors.resolve(url) == base(server) + "/github.com/geode-sdk/geode/releases/latest");
+    for (auto& mirror : mirrors.getRanked()) {
+        CHECK(!mirror.isOrigin());
+    }
+}
@@ -0,0 +1,175 @@
+#include "../Test.hpp"
+#include "FixtureServer.hpp"
+#include "PartialDownload.hpp"
+#include "include/SHA256.hpp"
+#include <chrono>
+#include <fstream>
+#include <optional>
+#include <random>
+
+#define BENCH_FILE_SIZE (4 * 1024 * 1024)
+// bytes per second per connection, like a 
+// server that throttles each client
+#define BENCH_BANDWIDTH (8 * 1024 * 1024)
+
+// hashing is measured over more data, since 
+// it isn't held back by a throttled server
+#define HASH_BENCH_SIZE (32 * 1024 * 1024)
+// like the data events of a web request
+#define HASH_BENCH_CHUNK 16384
+// a typical download speed, to put the time 
+// spent hashing into perspective
+#define HASH_BENCH_LINK (10 * 1024 * 1024)
+
+static size_t BENCH_SEGMENTS[] = { 1, 2, 4, 8 };
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+}
+
+/**
+ * Download the file like Manager::downloadFile 
+ * does, with one request per segment running 
+ * at the same time. Returns the time it took 
+ * in seconds
+ */
+static double download(
+    FixtureServer& server,
+    ghc::filesystem::path const& dir,
+    std::string const& file,
+    size_t segments
+) {
+    PartialDownload part(dir, "http://127.0.0.1/file");
+    auto start = std::chrono::steady_clock::now();
+    if (segments < 2) {
+        auto res = fixtureGet(server.getPort());
+        CHECK_OK(res);
+        auto response = res.value();
+        CHECK(response.m_status == 200 && response.m_complete);
+        CHECK_OK(part.begin(false, response.m_headers["etag"], ""));
+        CHECK_OK(part.write(response.m_body.data(), response.m_body.size()));
+    } else {
+        CHECK_OK(part.beginSegmented(file.size(), segments, "\"v1\"", ""));
+        auto& parts = part.getSegments();
+        std::vector<std::thread> threads;
+        std::vector<std::optional<Result<FixtureResponse>>> responses(parts.size());
+        for (size_t i = 0; i < parts.size(); i++) {
+            threads.emplace_back([&, i]() -> void {
+                auto range =
+                    "bytes=" + std::to_string(parts[i].getPosition()) + "-" +
+                    std::to_string(parts[i].m_end - 1);
+                responses[i].emplace(fixtureGet(server.getPort(), {
+                    { "Range", range },
+                    { "If-Range", "\"v1\"" },
+                }));
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        // written in one go per segment since only 
+        // the transfer is being measured
+        for (size_t i = 0; i < parts.size(); i++) {
+            CHECK_OK(*responses[i]);
+            auto response = responses[i]->value();
+            CHECK(response.m_status == 206 && response.m_complete);
+            CHECK_OK(part.writeSegment(i, response.m_body.data(), response.m_body.size()));
+        }
+        CHECK(part.getSegmentedProgress() == file.size());
+    }
+    auto seconds = secondsSince(start);
+
+    auto digest = part.getHash();
+    CHECK_OK(digest);
+    SHA256 sha;
+    sha.update(file.data(), file.size());
+    CHECK(digest.value() == sha.finish());
+    CHECK_OK(part.close());
+    part.discard();
+    return seconds;
+}
+
+TEST_CASE(PartialDownload, segmentedThroughput) {
+    auto dir = getTestDirectory("segmented-bench");
+    std::mt19937 random(5);
+    std::string file(BENCH_FILE_SIZE, '\0');
+    for (auto& c : file) {
+        c = static_cast<char>(random());
+    }
+    FixtureServerOptions options;
+    options.m_bandwidth = BENCH_BANDWIDTH;
+    FixtureServer server(options);
+    server.setFile(file, "\"v1\"");
+    CHECK_OK(server.start());
+
+    double single = 0.0;
+    for (auto segments : BENCH_SEGMENTS) {
+        auto seconds = download(server, dir, file, segments);
+        report(
+            segments < 2 ? "single stream" : std::to_string(segments) + " segments",
+            file.size() / seconds / (1024 * 1024), "MB/s"
+        );
+        if (segments < 2) {
+            single = seconds;
+        } else if (segments == 4) {
+            // the throttle is per connection, so 
+            // segments should add up
+            CHECK(seconds < single);
+        }
+    }
+}
+
+TEST_CASE(PartialDownload, hashingOverhead) {
+    // downloads are hashed as they're written, so 
+    // this is what verifying digests costs on top 
+    // of just storing the data
+    auto dir = getTestDirectory("hash-bench");
+    std::mt19937 random(6);
+    std::string data(HASH_BENCH_SIZE, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(random());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    SHA256 sha;
+    for (size_t i = 0; i < data.size(); i += HASH_BENCH_CHUNK) {
+        sha.update(data.data() + i, HASH_BENCH_CHUNK);
+    }
+    auto expected = sha.finish();
+    auto hashTime = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    {
+        std::ofstream ofs(dir / "plain.bin", std::ios::binary);
+        for (size_t i = 0; i < data.size(); i += HASH_BENCH_CHUNK) {
+            ofs.write(data.data() + i, HASH_BENCH_CHUNK);
+        }
+        CHECK(ofs.good());
+    }
+    auto plainTime = secondsSince(start);
+
+    PartialDownload part(dir, "http://127.0.0.1/file");
+    start = std::chrono::steady_clock::now();
+    CHECK_OK(part.begin(false, "\"v1\"", ""));
+    for (size_t i = 0; i < data.size(); i += HASH_BENCH_CHUNK) {
+        CHECK_OK(part.write(data.data() + i, HASH_BENCH_CHUNK));
+    }
+    auto digest = part.getHash();
+    CHECK_OK(part.close());
+    auto hashedTime = secondsSince(start);
+    CHECK_OK(digest);
+    CHECK(digest.value() == expected);
+    part.discard();
+
+    auto mb = HASH_BENCH_SIZE / (1024.0 * 1024.0);
+    report("SHA-256", mb / hashTime, "MB/s");
+    report("plain write", mb / plainTime, "MB/s");
+    report("hashed write", mb / hashedTime, "MB/s");
+    report("hashing overhead", (hashedTime - plainTime) / plainTime * 100.0, "%");
+    report(
+        "hashing time of a download at 10 MB/s",
+        hashTime / (HASH_BENCH_SIZE / static_cast<double>(HASH_BENCH_LINK)) * 100.0, "%"
+    );
+}
@@ -0,0 +1,166 @@
+#include "../Test.hpp"
+#include "FixtureServer.hpp"
+#include "PartialDownload.hpp"
+#include "include/SHA256.hpp"
+#include <algorithm>
+#include <random>
+
+#define RESUME_FILE_SIZE (1024 * 1024)
+#define RESUME_CUT_AT (300 * 1024)
+
+static std::string makeFile(size_t size, unsigned seed) {
+    std::mt19937 random(seed);
+    std::string data(size, '\0');
+    for (auto& c : data) {
+        c = static_cast<char>(random());
+    }
+    return data;
+}
+
+static std::string hash(std::string const& data) {
+    SHA256 sha;
+    sha.update(data.data(), data.size());
+    return sha.finish();
+}
+
+/**
+ * Does what Manager::downloadFileStream does 
+ * with a response: start or continue the 
+ * partial file depending on the status
+ */
+static void receive(PartialDownload& part, FixtureResponse& res) {
+    CHECK(res.m_status == 200 || res.m_status == 206);
+    if (res.m_status == 206) {
+        long long start, total;
+        CHECK(parseContentRange(res.m_headers["content-range"], start, total));
+        CHECK(start == static_cast<long long>(part.getSize()));
+    }
+    CHECK_OK(part.begin(res.m_status == 206, res.m_headers["etag"], ""));
+    // written in pieces like data events
+    for (size_t i = 0; i < res.m_body.size(); i += 16384) {
+        auto size = std::min<size_t>(16384, res.m_body.size() - i);
+        CHECK_OK(part.write(res.m_body.data() + i, size));
+    }
+}
+
+static std::map<std::string, std::string> resumeHeaders(PartialDownload& part) {
+    if (!part.canResume()) return {};
+    return {
+        { "Range", "bytes=" + std::to_string(part.getSize()) + "-" },
+        { "If-Range", part.getValidator() },
+    };
+}
+
+TEST_CASE(PartialDownload, resumesAfterDroppedConnection) {
+    auto dir = getTestDirectory("resume");
+    auto file = makeFile(RESUME_FILE_SIZE, 1);
+    FixtureServer server;
+    server.setFile(file, "\"v1\"");
+    CHECK_OK(server.start());
+    auto url = "http://127.0.0.1/file";
+
+    server.cutNextAfter(RESUME_CUT_AT);
+    {
+        PartialDownload part(dir, url);
+        CHECK(!part.canResume());
+        auto res = fixtureGet(server.getPort(), resumeHeaders(part));
+        CHECK_OK(res);
+        auto response = res.value();
+        CHECK(!response.m_complete);
+        receive(part, response);
+        CHECK_OK(part.close());
+    }
+
+    // as if the installer had been restarted
+    PartialDownload part(dir, url);
+    CHECK(part.canResume());
+    CHECK(part.getSize() == RESUME_CUT_AT);
+    CHECK(part.getValidator() == "\"v1\"");
+    auto res = fixtureGet(server.getPort(), resumeHeaders(part));
+    CHECK_OK(res);
+    auto response = res.value();
+    CHECK(response.m_status == 206);
+    CHECK(response.m_complete);
+    CHECK(response.m_body.size() == RESUME_FILE_SIZE - RESUME_CUT_AT);
+    receive(part, response);
+
+    auto digest = part.getHash();
+    CHECK_OK(digest);
+    CHECK(digest.value() == hash(file));
+    CHECK_OK(part.close());
+    CHECK(part.getSize() == RESUME_FILE_SIZE);
+
+    auto ranges = server.getRanges();
+    CHECK(ranges.size() == 2);
+    CHECK(ranges[0].empty());
+    CHECK(ranges[1] == "bytes=" + std::to_string(RESUME_CUT_AT) + "-");
+}
+
+TEST_CASE(PartialDownload, restartsWhenFileChanged) {
+    auto dir = getTestDirectory("resume-changed");
+    FixtureServer server;
+    server.setFile(makeFile(RESUME_FILE_SIZE, 2), "\"v1\"");
+    CHECK_OK(server.start());
+    auto url = "http://127.0.0.1/file";
+
+    server.cutNextAfter(RESUME_CUT_AT);
+    {
+        PartialDownload part(dir, url);
+        auto res = fixtureGet(server.getPort());
+        CHECK_OK(res);
+        auto response = res.value();
+        receive(part, response);
+        CHECK_OK(part.close());
+    }
+
+    // the If-Range validator no longer matches, 
+    // so the server sends all of the new file
+    auto changed = makeFile(RESUME_FILE_SIZE / 2, 3);
+    server.setFile(changed, "\"v2\"");
+    PartialDownload part(dir, url);
+    CHECK(part.canResume());
+    auto res = fixtureGet(server.getPort(), resumeHeaders(part));
+    CHECK_OK(res);
+    auto response = res.value();
+    CHECK(response.m_status == 200);
+    receive(part, response);
+    CHECK_OK(part.close());
+
+    CHECK(part.getSize() == changed.size());
+    CHECK(part.getETag() == "\"v2\"");
+    CHECK(SHA256::hashFile(part.getPath()) == hash(changed));
+}
+
+TEST_CASE(PartialDownload, cutsEveryAttempt) {
+    // a link that keeps dropping still gets 
+    // the file there a piece at a time
+    auto dir = getTestDirectory("resume-flaky");
+    auto file = makeFile(RESUME_FILE_SIZE, 4);
+    FixtureServer server;
+    server.setFile(file, "\"v1\"");
+    CHECK_OK(server.start());
+
+    size_t attempts = 0;
+    PartialDownload part(dir, "http://127.0.0.1/file");
+    while (part.getSize() < file.size()) {
+        CHECK(++attempts <= RESUME_FILE_SIZE / RESUME_CUT_AT + 1);
+        server.cutNextAfter(RESUME_CUT_AT);
+        auto res = fixtureGet(server.getPort(), resumeHeaders(part));
+        CHECK_OK(res);
+        auto response = res.value();
+        receive(part, response);
+        CHECK_OK(part.close());
+    }
+    CHECK(attempts == RESUME_FILE_SIZE / RESUME_CUT_AT + 1);
+    CHECK(SHA256::hashFile(part.getPath()) == hash(file));
+}
+
+TEST_CASE(PartialDownload, parsesContentRange) {
+    long long start, total;
+    CHECK(parseContentRange("bytes 100-199/200", start, total));
+    CHECK(start == 100 && total == 200);
+    CHECK(parseContentRange("bytes 0-9/*", start, total));
+    CHECK(start == 0 && total == -1);
+    CHECK(!parseContentRange("bytes */200", start, total));
+    CHECK(!parseContentRange("", start, total));
+}
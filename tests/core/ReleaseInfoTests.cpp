@@ -0,0 +1,171 @@
+#include "../Test.hpp"
+#include "../Allocations.hpp"
+#include "ReleaseInfo.hpp"
+#include "include/json.hpp"
+#include <chrono>
+
+// a release with a lot of assets, each with 
+// the uploader & everything else GitHub lists
+#define BENCH_ASSETS 500
+#define BENCH_RUNS 20
+
+static std::string makeAsset(size_t index) {
+    auto name = "geode-cli-v1.0." + std::to_string(index) + "-win.zip";
+    return R"({
+        "url": "https://api.github.com/repos/geode-sdk/cli/releases/assets/)" + std::to_string(index) + R"(",
+        "id": )" + std::to_string(100000 + index) + R"(,
+        "node_id": "RA_kwDOGLqmGs4G9sQr",
+        "name": ")" + name + R"(",
+        "label": "",
+        "uploader": {
+            "login": "github-actions[bot]",
+            "id": 41898282,
+            "node_id": "MDM6Qm90NDE4OTgyODI=",
+            "avatar_url": "https://avatars.githubusercontent.com/in/15368?v=4",
+            "gravatar_id": "",
+            "url": "https://api.github.com/users/github-actions%5Bbot%5D",
+            "html_url": "https://github.com/apps/github-actions",
+            "type": "Bot",
+            "site_admin": false
+        },
+        "content_type": "application/zip",
+        "state": "uploaded",
+        "size": 4195431,
+        "digest": "sha256:)" + std::string(64, 'a') + R"(",
+        "download_count": 1520,
+        "created_at": "2024-05-01T12:00:00Z",
+        "updated_at": "2024-05-01T12:00:00Z",
+        "browser_download_url": "https://github.com/geode-sdk/cli/releases/download/v1.0.0/)" + name + R"("
+    })";
+}
+
+static std::string makeRelease(size_t assets) {
+    std::string json = R"({
+        "url": "https://api.github.com/repos/geode-sdk/cli/releases/1",
+        "author": { "login": "github-actions[bot]", "id": 41898282 },
+        "tag_name": "v1.0.0",
+        "name": "Geode CLI v1.0.0",
+        "draft": false,
+        "assets": [)";
+    for (size_t i = 0; i < assets; i++) {
+        if (i) json += ",";
+        json += makeAsset(i);
+    }
+    json += R"(],
+        "body": "Changes:\n- things",
+        "reactions": { "total_count": 3, "+1": 3 }
+    })";
+    return json;
+}
+
+TEST_CASE(ReleaseInfo, picksOutFields) {
+    auto res = ReleaseInfo::parse(makeRelease(3));
+    CHECK_OK(res);
+    auto info = res.value();
+    CHECK(info.m_tagName == "v1.0.0");
+    CHECK(info.m_assets.size() == 3);
+    CHECK(info.m_assets[1].m_name == "geode-cli-v1.0.1-win.zip");
+    CHECK(info.m_assets[1].m_url == "https://github.com/geode-sdk/cli/releases/download/v1.0.0/geode-cli-v1.0.1-win.zip");
+    CHECK(info.m_assets[1].m_digest == "sha256:" + std::string(64, 'a'));
+    // the uploader's fields aren't the asset's
+    CHECK(info.m_assets[0].m_url.find("api.github.com") == std::string::npos);
+}
+
+TEST_CASE(ReleaseInfo, findsAssetBySuffix) {
+    auto res = ReleaseInfo::parse(R"({
+        "tag_name": "v2.0.0",
+        "assets": [
+            { "name": "geode-cli-v2.0.0-win.tar.zst" },
+            { "name": "geode-cli-v2.0.0-win.zip" },
+            { "name": "geode-cli-v2.0.0-mac.zip" }
+        ]
+    })");
+    CHECK_OK(res);
+    auto info = res.value();
+    auto asset = info.findAsset("win", ".zip");
+    CHECK(asset && asset->m_name == "geode-cli-v2.0.0-win.zip");
+    asset = info.findAsset("win");
+    CHECK(asset && asset->m_name == "geode-cli-v2.0.0-win.tar.zst");
+    CHECK(!info.findAsset("linux"));
+    CHECK(!info.findAsset("mac", ".tar.zst"));
+}
+
+TEST_CASE(ReleaseInfo, ignoresUnexpectedShapes) {
+    // arrays & values where the assets' objects 
+    // should be don't count as assets
+    auto res = ReleaseInfo::parse(R"({
+        "assets": [["x"], "y", 1, { "name": "a.zip", "extra": [["z"]] }],
+        "tag_name": "v3.0.0",
+        "other": [{ "tag_name": "nope" }]
+    })");
+    CHECK_OK(res);
+    auto info = res.value();
+    CHECK(info.m_tagName == "v3.0.0");
+    CHECK(info.m_assets.size() == 1);
+    CHECK(info.m_assets[0].m_name == "a.zip");
+
+    // only the release's own "assets" key
+    auto nested = ReleaseInfo::parse(R"({
+        "tag_name": "v3.0.0",
+        "author": { "assets": [{ "name": "b.zip" }] },
+        "list": [{ "assets": [{ "name": "c.zip" }] }]
+    })");
+    CHECK_OK(nested);
+    CHECK(nested.value().m_assets.empty());
+
+    CHECK(!ReleaseInfo::parse(R"([["x"]])"));
+    CHECK(!ReleaseInfo::parse(R"({ "tag_name": "v1", "assets": [)"));
+}
+
+TEST_CASE(ReleaseInfo, benchmarkAgainstDocument) {
+    auto json = makeRelease(BENCH_ASSETS);
+    report("release size", json.size() / 1024.0, "KB");
+
+    auto measure = [&](auto func) {
+        resetAllocationPeak();
+        auto before = getAllocationStats();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < BENCH_RUNS; i++) {
+            func();
+        }
+        auto time = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start
+        ).count() / BENCH_RUNS;
+        auto after = getAllocationStats();
+        return std::make_tuple(
+            time,
+            (after.m_count - before.m_count) / BENCH_RUNS,
+            after.m_peak - before.m_peak
+        );
+    };
+
+    // what the installer used to do: build the 
+    // whole document & read three fields off it
+    auto [domTime, domCount, domPeak] = measure([&]() {
+        auto doc = nlohmann::json::parse(json);
+        ReleaseInfo info;
+        info.m_tagName = doc["tag_name"].get<std::string>();
+        for (auto& asset : doc["assets"]) {
+            info.m_assets.push_back({
+                asset["name"].get<std::string>(),
+                asset["browser_download_url"].get<std::string>(),
+                asset["digest"].get<std::string>(),
+            });
+        }
+        CHECK(info.m_assets.size() == BENCH_ASSETS);
+    });
+    auto [saxTime, saxCount, saxPeak] = measure([&]() {
+        auto res = ReleaseInfo::parse(json);
+        CHECK_OK(res);
+        CHECK(res.value().m_assets.size() == BENCH_ASSETS);
+    });
+
+    report("document parse", domTime, "ms");
+    report("document allocations", static_cast<double>(domCount), "");
+    report("document peak heap", domPeak / 1024.0, "KB");
+    report("SAX parse", saxTime, "ms");
+    report("SAX allocations", static_cast<double>(saxCount), "");
+    report("SAX peak heap", saxPeak / 1024.0, "KB");
+    CHECK(saxPeak < domPeak);
+    CHECK(saxCount < domCount);
+}
@@ -0,0 +1,154 @@
+#include "../Test.hpp"
+#include "RequestRegistry.hpp"
+#include "RequestScheduler.hpp"
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <set>
+
+#define STRESS_REQUESTS 10000
+#define STRESS_MAX_RUNNING 6
+// requests in flight at once, so 
+// some always have to wait
+#define STRESS_IN_FLIGHT 64
+// gives up if the requests stop finishing
+#define STRESS_MAX_STEPS 100000
+
+/**
+ * Stands in for Manager's WebRequestHandlers
+ */
+struct TestHandlers {
+    std::function<void()> m_stateFunc;
+    std::function<void()> m_dataFunc;
+    size_t m_received = 0;
+};
+
+static RequestPriority randomPriority(std::mt19937& random) {
+    return static_cast<RequestPriority>(random() % 3);
+}
+
+TEST_CASE(RequestRegistry, routesUntilFinished) {
+    RequestRegistry<TestHandlers> registry;
+    size_t states = 0;
+    registry.add(1).m_stateFunc = [&states]() { states++; };
+    registry.get(1).m_dataFunc = [&registry]() { registry.find(1)->m_received++; };
+    registry.add(2);
+    CHECK(registry.getActiveCount() == 2);
+    CHECK(registry.getTotalCount() == 2);
+
+    auto handlers = registry.find(1);
+    CHECK(handlers);
+    handlers->m_dataFunc();
+    handlers->m_dataFunc();
+    CHECK(registry.find(1)->m_received == 2);
+    CHECK(!registry.find(3));
+
+    // the last handler runs after the entry is gone
+    auto finished = registry.finish(1);
+    CHECK(finished.has_value());
+    CHECK(finished->m_received == 2);
+    CHECK(!registry.contains(1));
+    finished->m_stateFunc();
+    CHECK(states == 1);
+
+    // late events of a finished request go nowhere
+    CHECK(!registry.find(1));
+    CHECK(!registry.finish(1).has_value());
+    CHECK(registry.getActiveCount() == 1);
+    CHECK(registry.getTotalCount() == 2);
+}
+
+TEST_CASE(RequestRegistry, stressTenThousandRequests) {
+    // drives the registry & the scheduler the way 
+    // Manager does: every request is added when 
+    // it's created, its events are routed through 
+    // the registry, and its entry is removed when 
+    // it finishes or is cancelled. New requests 
+    // are only held back by the scheduler, so a 
+    // registry that kept finished entries around 
+    // would keep growing
+    RequestRegistry<TestHandlers> registry;
+    RequestScheduler scheduler;
+    scheduler.setMaxRunning(STRESS_MAX_RUNNING);
+    std::mt19937 random(5);
+
+    std::set<int> started;
+    std::vector<int> running;
+    size_t called = 0;
+    size_t routed = 0;
+    size_t peak = 0;
+    size_t steps = 0;
+    int next = 0;
+
+    auto finish = [&](int id) {
+        auto handlers = registry.finish(id);
+        CHECK(handlers.has_value());
+        scheduler.finish(id);
+        handlers->m_stateFunc();
+        // wx may still deliver events that were 
+        // queued before the request finished
+        CHECK(!registry.find(id));
+    };
+
+    while (next < STRESS_REQUESTS || scheduler.getTrackedCount()) {
+        CHECK(++steps < STRESS_MAX_STEPS);
+        while (scheduler.getTrackedCount() < STRESS_IN_FLIGHT && next < STRESS_REQUESTS) {
+            auto id = next++;
+            auto& handlers = registry.add(id);
+            handlers.m_stateFunc = [&called]() { called++; };
+            handlers.m_dataFunc = [&routed]() { routed++; };
+            scheduler.enqueue(id, randomPriority(random));
+        }
+        // now & then someone waits on a 
+        // request or gives up on it
+        if (scheduler.getTrackedCount() && random() % 4 == 0) {
+            auto it = std::next(registry.begin(), random() % registry.getActiveCount());
+            scheduler.raisePriority(it->first, RequestPriority::Interactive);
+        }
+        if (scheduler.getTrackedCount() && random() % 8 == 0) {
+            auto it = std::next(registry.begin(), random() % registry.getActiveCount());
+            if (!scheduler.isStarted(it->first)) {
+                finish(it->first);
+            }
+        }
+
+        int id;
+        while (scheduler.startNext(id)) {
+            CHECK(registry.contains(id));
+            CHECK(started.insert(id).second);
+            running.push_back(id);
+            CHECK(scheduler.getRunningCount() <= STRESS_MAX_RUNNING);
+        }
+        CHECK(scheduler.getRunningCount() == running.size());
+        CHECK(registry.getActiveCount() == scheduler.getTrackedCount());
+        peak = std::max(peak, registry.getActiveCount());
+
+        // data arrives for the running ones, which 
+        // then finish in any order
+        for (auto id : running) {
+            auto handlers = registry.find(id);
+            CHECK(handlers);
+            handlers->m_dataFunc();
+        }
+        std::shuffle(running.begin(), running.end(), random);
+        auto count = running.size() ? random() % running.size() + 1 : 0;
+        for (size_t i = 0; i < count; i++) {
+            finish(running.back());
+            running.pop_back();
+        }
+    }
+
+    CHECK(called == STRESS_REQUESTS);
+    CHECK(registry.getActiveCount() == 0);
+    CHECK(registry.getTotalCount() == STRESS_REQUESTS);
+    CHECK(scheduler.getTrackedCount() == 0);
+    CHECK(scheduler.getRunningCount() == 0);
+    CHECK(scheduler.getQueuedCount() == 0);
+    report("peak live handlers", static_cast<double>(peak), "");
+    report("routed data events", static_cast<double>(routed), "");
+    report("scheduling steps", static_cast<double>(steps), "");
+    // finished requests don't linger, so this 
+    // is bound by what's in flight & not by 
+    // the number of requests made
+    CHECK(peak <= STRESS_IN_FLIGHT);
+}
@@ -0,0 +1,60 @@
+#include "../Test.hpp"
+#include "RequestScheduler.hpp"
+
+TEST_CASE(RequestScheduler, keepsSlotsFree) {
+    RequestScheduler scheduler;
+    scheduler.setMaxRunning(4);
+    int id;
+    for (int i = 0; i < 4; i++) {
+        scheduler.enqueue(i, RequestPriority::Bulk);
+    }
+    // one slot is left for interactive requests
+    while (scheduler.startNext(id));
+    CHECK(scheduler.getRunningCount() == 3);
+    scheduler.enqueue(10, RequestPriority::Speculative);
+    CHECK(!scheduler.startNext(id));
+    scheduler.enqueue(11, RequestPriority::Interactive);
+    CHECK(scheduler.startNext(id) && id == 11);
+    CHECK(!scheduler.startNext(id));
+
+    // speculative requests wait until everything 
+    // else has finished
+    for (int i = 0; i < 4; i++) {
+        scheduler.finish(i);
+    }
+    scheduler.finish(11);
+    CHECK(scheduler.startNext(id) && id == 10);
+    CHECK(scheduler.isStarted(10));
+    scheduler.finish(10);
+    CHECK(scheduler.getTrackedCount() == 0);
+}
+
+TEST_CASE(RequestScheduler, raisesWaitingRequests) {
+    RequestScheduler scheduler;
+    scheduler.setMaxRunning(2);
+    int id;
+    scheduler.enqueue(1, RequestPriority::Interactive);
+    scheduler.enqueue(2, RequestPriority::Interactive);
+    scheduler.enqueue(3, RequestPriority::Speculative);
+    scheduler.enqueue(4, RequestPriority::Bulk);
+    while (scheduler.startNext(id));
+    CHECK(scheduler.getRunningCount() == 2);
+
+    // someone started waiting on the speculative 
+    // one, so it goes ahead of the bulk one
+    scheduler.raisePriority(3, RequestPriority::Interactive);
+    CHECK(scheduler.getPriority(3) == RequestPriority::Interactive);
+    scheduler.finish(1);
+    CHECK(scheduler.startNext(id) && id == 3);
+    // lowering isn't a thing
+    scheduler.raisePriority(3, RequestPriority::Speculative);
+    CHECK(scheduler.getPriority(3) == RequestPriority::Interactive);
+
+    // cancelled before it got to start
+    scheduler.finish(4);
+    scheduler.finish(2);
+    scheduler.finish(3);
+    CHECK(!scheduler.startNext(id));
+    CHECK(scheduler.getTrackedCount() == 0);
+    CHECK(scheduler.getQueuedCount() == 0);
+}
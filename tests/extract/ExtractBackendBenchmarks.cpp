@@ -0,0 +1,63 @@
+#include "../Test.hpp"
+#include "TestArchive.hpp"
+#include "Extract.hpp"
+#include "FileWriter.hpp"
+#include <chrono>
+
+#define WX_INIT() \
+    wxInitializer wxInit; \
+    CHECK(wxInit.IsOk())
+
+#define BACKEND_FILES 8
+#define BACKEND_FILE_SIZE (16 * 1024 * 1024)
+#define BACKEND_RUNS 3
+
+TEST_CASE(Extract, mappedAgainstStreams) {
+    WX_INIT();
+    auto dir = getTestDirectory("ExtractBackends");
+    // half stored, which the mapping can hand to 
+    // the writer as it is, half deflated
+    std::vector<TestArchiveEntry> entries;
+    size_t total = 0;
+    for (size_t i = 0; i < BACKEND_FILES; i++) {
+        entries.push_back({
+            "large/" + std::to_string(i) + ".bin",
+            makeTestData(BACKEND_FILE_SIZE, static_cast<unsigned>(i)),
+            i % 2 == 0
+        });
+        total += BACKEND_FILE_SIZE;
+    }
+    auto zip = dir / "large.zip";
+    CHECK_OK(writeTestZip(zip, entries));
+
+    auto measure = [&](std::string const& name, bool mapped) {
+        ExtractOptions options;
+        options.m_mapped = mapped;
+        // one thread, so only the reading differs
+        options.m_threads = 1;
+        double best = 0.0;
+        for (size_t run = 0; run < BACKEND_RUNS; run++) {
+            auto out = dir / ("out-" + name);
+            ghc::filesystem::remove_all(out);
+            DiskTarget target;
+            FileWriter::resetStats();
+            auto start = std::chrono::steady_clock::now();
+            CHECK_OK(extractArchive(zip, target, out, nullptr, ghc::filesystem::path(), options));
+            auto seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start
+            ).count();
+            best = std::max(best, total / seconds / (1024 * 1024));
+        }
+        auto stats = FileWriter::getStats();
+        report(name, best, "MB/s");
+        report(name + " bytes copied into write buffers", stats.m_bufferedBytes / (1024.0 * 1024.0), "MB");
+        return stats;
+    };
+    auto streams = measure("wx streams", false);
+    auto mapped = measure("mapped", true);
+
+    // stored entries go from the mapping to 
+    // the file without being copied, any size
+    CHECK(mapped.m_bufferedBytes < streams.m_bufferedBytes);
+    CHECK(mapped.m_bufferedBytes <= total / 2);
+}
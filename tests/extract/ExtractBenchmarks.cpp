@@ -0,0 +1,76 @@
+#include "../Test.hpp"
+#include "TestArchive.hpp"
+#include "Extract.hpp"
+#include <chrono>
+
+#define WX_INIT() \
+    wxInitializer wxInit; \
+    CHECK(wxInit.IsOk())
+
+#define SMALL_FILES 3000
+#define SMALL_FILE_SIZE (4 * 1024)
+#define LARGE_FILES 4
+#define LARGE_FILE_SIZE (8 * 1024 * 1024)
+
+static size_t BENCH_THREADS[] = { 1, 2, 4, 8 };
+
+static std::vector<TestArchiveEntry> makeFiles(size_t count, size_t size) {
+    std::vector<TestArchiveEntry> entries;
+    for (size_t i = 0; i < count; i++) {
+        entries.push_back({
+            "files/" + std::to_string(i % 20) + "/" + std::to_string(i) + ".bin",
+            makeTestData(size, static_cast<unsigned>(i)),
+            false
+        });
+    }
+    return entries;
+}
+
+/**
+ * Extract the archive into memory with each 
+ * thread count, checking that the output is 
+ * the same every time
+ */
+static void benchmarkThreads(
+    std::string const& name,
+    std::vector<TestArchiveEntry> const& entries
+) {
+    auto dir = getTestDirectory("ExtractThreads-" + name);
+    auto zip = dir / "bench.zip";
+    CHECK_OK(writeTestZip(zip, entries));
+    size_t total = 0;
+    for (auto& entry : entries) {
+        total += entry.m_data.size();
+    }
+
+    for (auto threads : BENCH_THREADS) {
+        MemoryTarget target;
+        ExtractOptions options;
+        options.m_threads = threads;
+        auto start = std::chrono::steady_clock::now();
+        CHECK_OK(extractArchive(zip, target, dir / "out", nullptr, ghc::filesystem::path(), options));
+        auto seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start
+        ).count();
+        report(
+            name + ", " + std::to_string(threads) + " threads",
+            total / seconds / (1024 * 1024), "MB/s"
+        );
+
+        CHECK(target.getFileNames().size() == entries.size());
+        for (auto& entry : entries) {
+            auto data = target.getFile(dir / "out" / entry.m_name);
+            CHECK(data && std::string(data->begin(), data->end()) == entry.m_data);
+        }
+    }
+}
+
+TEST_CASE(Extract, threadsOnManySmallFiles) {
+    WX_INIT();
+    benchmarkThreads("many small files", makeFiles(SMALL_FILES, SMALL_FILE_SIZE));
+}
+
+TEST_CASE(Extract, threadsOnFewLargeFiles) {
+    WX_INIT();
+    benchmarkThreads("few large files", makeFiles(LARGE_FILES, LARGE_FILE_SIZE));
+}
@@ -0,0 +1,242 @@
+#include "../Test.hpp"
+#include "TestArchive.hpp"
+#include "Extract.hpp"
+#include "ExtractIndex.hpp"
+#include "FileWriter.hpp"
+#include "ZstdStream.hpp"
+#include <wx/mstream.h>
+#include <wx/wfstream.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+/**
+ * wx has to be set up for its streams to 
+ * find their conversions & class info
+ */
+#define WX_INIT() \
+    wxInitializer wxInit; \
+    CHECK(wxInit.IsOk())
+
+static std::vector<TestArchiveEntry> makeEntries() {
+    return {
+        { "readme.txt", "stored & tiny", true },
+        { "bin/", "", false },
+        { "bin/geode", makeTestData(300 * 1024, 1), false },
+        { "bin/data/big.bin", makeTestData(2 * 1024 * 1024, 2), true },
+        { "bin/data/small.json", makeTestData(700, 3), false },
+        { "empty/", "", false },
+        { "deep/a/b/c/d.txt", makeTestData(5000, 4), false },
+    };
+}
+
+static void checkExtracted(
+    MemoryTarget const& target,
+    ghc::filesystem::path const& to,
+    std::vector<TestArchiveEntry> const& entries
+) {
+    size_t files = 0;
+    for (auto& entry : entries) {
+        if (entry.m_name.back() == '/') {
+            CHECK(target.hasDirectory(to / entry.m_name.substr(0, entry.m_name.size() - 1)));
+            continue;
+        }
+        auto data = target.getFile(to / entry.m_name);
+        CHECK(data);
+        CHECK(std::string(data->begin(), data->end()) == entry.m_data);
+        files++;
+    }
+    CHECK(target.getFileNames().size() == files);
+    CHECK(target.hasDirectory(to / "deep" / "a" / "b" / "c"));
+    // nothing was written to the real disk
+    CHECK(!ghc::filesystem::exists(to));
+}
+
+TEST_CASE(Extract, archiveIntoMemory) {
+    WX_INIT();
+    auto dir = getTestDirectory("Extract-archive");
+    auto entries = makeEntries();
+    CHECK_OK(writeTestZip(dir / "test.zip", entries));
+
+    MemoryTarget target;
+    CHECK_OK(extractArchive(dir / "test.zip", target, dir / "out"));
+    checkExtracted(target, dir / "out", entries);
+}
+
+TEST_CASE(Extract, streamIntoMemory) {
+    WX_INIT();
+    auto dir = getTestDirectory("Extract-stream");
+    auto entries = makeEntries();
+    CHECK_OK(writeTestZip(dir / "test.zip", entries));
+
+    wxFileInputStream file((dir / "test.zip").wstring());
+    CHECK(file.IsOk());
+    MemoryTarget target;
+    CHECK_OK(extractStream(file, target, dir / "out"));
+    checkExtracted(target, dir / "out", entries);
+}
+
+TEST_CASE(Extract, rejectsCorruptEntries) {
+    WX_INIT();
+    auto dir = getTestDirectory("Extract-corrupt");
+    auto entries = makeEntries();
+    CHECK_OK(writeTestZip(dir / "test.zip", entries));
+
+    // flip a byte in the middle of the stored 
+    // file so only its CRC can tell
+    std::fstream file((dir / "test.zip").string(), std::ios::in | std::ios::out | std::ios::binary);
+    std::string zip((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    auto& big = entries[3].m_data;
+    auto pos = zip.find(big.substr(big.size() / 2, 64));
+    CHECK(pos != std::string::npos);
+    file.clear();
+    file.seekp(static_cast<std::streamoff>(pos));
+    file.put(static_cast<char>(zip[pos] ^ 0x40));
+    file.close();
+
+    MemoryTarget target;
+    CHECK(!extractArchive(dir / "test.zip", target, dir / "out"));
+}
+
+TEST_CASE(Extract, streamReusesUnchangedFiles) {
+    WX_INIT();
+    auto dir = getTestDirectory("Extract-reuse");
+    auto entries = makeEntries();
+    CHECK_OK(writeTestZip(dir / "old.zip", entries));
+    // the new version changes one file
+    entries[2].m_data = makeTestData(300 * 1024, 10);
+    CHECK_OK(writeTestZip(dir / "new.zip", entries));
+
+    ExtractIndex index(dir / "index.json");
+    DiskTarget disk;
+    CHECK_OK(extractArchive(dir / "old.zip", disk, dir / "installed", &index));
+
+    // like the streamed install: a fresh staging 
+    // directory with the installed one as current
+    wxFileInputStream file((dir / "new.zip").wstring());
+    CHECK(file.IsOk());
+    FileWriter::resetStats();
+    CHECK_OK(extractStream(file, disk, dir / "staging", &index, dir / "installed"));
+    CHECK(FileWriter::getStats().m_files == 1);
+
+    for (auto& entry : entries) {
+        if (entry.m_name.back() == '/') continue;
+        auto staged = dir / "staging" / entry.m_name;
+        std::ifstream in(staged.string(), std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        CHECK(data == entry.m_data);
+        auto linked = ghc::filesystem::equivalent(staged, dir / "installed" / entry.m_name);
+        CHECK(linked == (entry.m_name != entries[2].m_name));
+    }
+}
+
+#ifdef GEODE_HAS_ZSTD
+// tar bytes per Zstandard frame, so entries 
+// & reads straddle frames
+#define TAR_ZST_FRAME_SIZE (100 * 1000 + 7)
+// odd so the reads never line up with 
+// frames or tar blocks
+#define TAR_ZST_CHUNK_SIZE 4093
+
+/**
+ * Hands out the data a few KB at a time, 
+ * like a download coming in would
+ */
+class ChunkedInputStream : public wxInputStream {
+protected:
+    std::string m_data;
+    size_t m_chunk;
+    size_t m_pos = 0;
+
+    size_t OnSysRead(void* buffer, size_t size) override {
+        auto count = std::min({ size, m_chunk, m_data.size() - m_pos });
+        if (!count) {
+            m_lasterror = wxSTREAM_EOF;
+            return 0;
+        }
+        std::memcpy(buffer, m_data.data() + m_pos, count);
+        m_pos += count;
+        return count;
+    }
+
+public:
+    ChunkedInputStream(std::string const& data, size_t chunk)
+      : m_data(data), m_chunk(chunk) {}
+};
+
+TEST_CASE(Extract, tarZstdIntoMemory) {
+    WX_INIT();
+    auto dir = getTestDirectory("Extract-tarzst");
+    auto entries = makeEntries();
+    auto data = makeTestTarZst(entries, TAR_ZST_FRAME_SIZE);
+    CHECK_OK(data);
+    CHECK(isZstdData(data.value().data(), data.value().size()));
+    {
+        std::ofstream ofs((dir / "test.tar.zst").string(), std::ios::binary);
+        ofs.write(data.value().data(), data.value().size());
+    }
+
+    // picked by its magic bytes, not the extension
+    MemoryTarget target;
+    CHECK_OK(extractArchive(dir / "test.tar.zst", target, dir / "out"));
+    checkExtracted(target, dir / "out", entries);
+
+    // a zip isn't mistaken for one
+    CHECK_OK(writeTestZip(dir / "test.zip", entries));
+    char magic[4] = {};
+    std::ifstream((dir / "test.zip").string(), std::ios::binary).read(magic, sizeof(magic));
+    CHECK(!isZstdData(magic, sizeof(magic)));
+}
+
+TEST_CASE(Extract, tarZstdInChunks) {
+    WX_INIT();
+    auto dir = getTestDirectory("Extract-tarzst-chunks");
+    auto entries = makeEntries();
+    auto data = makeTestTarZst(entries, TAR_ZST_FRAME_SIZE);
+    CHECK_OK(data);
+
+    ChunkedInputStream stream(data.value(), TAR_ZST_CHUNK_SIZE);
+    MemoryTarget target;
+    CHECK_OK(extractStream(stream, target, dir / "out"));
+    checkExtracted(target, dir / "out", entries);
+
+    // the decoder on its own gives back 
+    // exactly the tar, frame after frame
+    ChunkedInputStream raw(data.value(), TAR_ZST_CHUNK_SIZE);
+    ZstdInputStream zstd(raw);
+    size_t decoded = 0;
+    char buffer[1000];
+    while (zstd.Read(buffer, sizeof(buffer)).LastRead()) {
+        decoded += zstd.LastRead();
+    }
+    CHECK(zstd.GetLastError() == wxSTREAM_EOF);
+    // every tar entry is padded to 512 bytes
+    CHECK(decoded % 512 == 0);
+    CHECK(decoded > 2 * 1024 * 1024);
+}
+
+TEST_CASE(Extract, rejectsTruncatedTarZstd) {
+    WX_INIT();
+    auto dir = getTestDirectory("Extract-tarzst-truncated");
+    auto data = makeTestTarZst(makeEntries(), TAR_ZST_FRAME_SIZE);
+    CHECK_OK(data);
+
+    // cut off in the middle of a frame
+    auto half = data.value().substr(0, data.value().size() / 2);
+    wxMemoryInputStream stream(half.data(), half.size());
+    MemoryTarget target;
+    CHECK(!extractStream(stream, target, dir / "out"));
+
+    ChunkedInputStream chunked(half, TAR_ZST_CHUNK_SIZE);
+    MemoryTarget chunkedTarget;
+    CHECK(!extractStream(chunked, chunkedTarget, dir / "out"));
+
+    // nothing but the magic bytes
+    auto magic = data.value().substr(0, 4);
+    wxMemoryInputStream header(magic.data(), magic.size());
+    MemoryTarget empty;
+    CHECK(!extractStream(header, empty, dir / "out"));
+    CHECK(empty.getFileNames().empty());
+}
+#endif
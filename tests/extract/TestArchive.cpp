@@ -0,0 +1,103 @@
+#include "TestArchive.hpp"
+#include "include/wx.hpp"
+#include <wx/wfstream.h>
+#include <wx/mstream.h>
+#include <wx/tarstrm.h>
+#include <wx/zipstrm.h>
+#include <algorithm>
+#include <random>
+
+#ifdef GEODE_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+std::string makeTestData(size_t size, unsigned seed) {
+    std::mt19937 random(seed);
+    std::string data;
+    data.reserve(size);
+    while (data.size() < size) {
+        // runs of a few symbols with some noise
+        auto symbol = static_cast<char>('a' + random() % 16);
+        auto run = random() % 12 + 1;
+        for (size_t i = 0; i < run && data.size() < size; i++) {
+            data.push_back(random() % 8 ? symbol : static_cast<char>(random()));
+        }
+    }
+    return data;
+}
+
+Result<> writeTestZip(
+    ghc::filesystem::path const& path,
+    std::vector<TestArchiveEntry> const& entries
+) {
+    wxFileOutputStream file(path.wstring());
+    if (!file.IsOk()) {
+        return Err("Unable to create " + path.string());
+    }
+    wxZipOutputStream zip(file);
+    for (auto& info : entries) {
+        if (info.m_name.size() && info.m_name.back() == '/') {
+            if (!zip.PutNextDirEntry(wxString::FromUTF8(info.m_name))) {
+                return Err("Unable to add directory " + info.m_name);
+            }
+            continue;
+        }
+        auto entry = new wxZipEntry(wxString::FromUTF8(info.m_name));
+        entry->SetMethod(info.m_stored ? wxZIP_METHOD_STORE : wxZIP_METHOD_DEFLATE);
+        if (!zip.PutNextEntry(entry)) {
+            return Err("Unable to add " + info.m_name);
+        }
+        zip.Write(info.m_data.data(), info.m_data.size());
+        if (zip.LastWrite() != info.m_data.size()) {
+            return Err("Unable to write " + info.m_name);
+        }
+    }
+    if (!zip.Close() || !file.Close()) {
+        return Err("Unable to finish " + path.string());
+    }
+    return Ok();
+}
+
+#ifdef GEODE_HAS_ZSTD
+Result<std::string> makeTestTarZst(
+    std::vector<TestArchiveEntry> const& entries,
+    size_t frameSize
+) {
+    wxMemoryOutputStream out;
+    {
+        wxTarOutputStream tar(out);
+        for (auto& info : entries) {
+            if (info.m_name.size() && info.m_name.back() == '/') {
+                if (!tar.PutNextDirEntry(wxString::FromUTF8(info.m_name))) {
+                    return Err("Unable to add directory " + info.m_name);
+                }
+                continue;
+            }
+            if (!tar.PutNextEntry(wxString::FromUTF8(info.m_name))) {
+                return Err("Unable to add " + info.m_name);
+            }
+            tar.Write(info.m_data.data(), info.m_data.size());
+            if (tar.LastWrite() != info.m_data.size()) {
+                return Err("Unable to write " + info.m_name);
+            }
+        }
+        if (!tar.Close()) {
+            return Err("Unable to finish tar");
+        }
+    }
+    std::string data(out.GetSize(), '\0');
+    out.CopyTo(&data[0], data.size());
+
+    std::string compressed;
+    for (size_t pos = 0; pos < data.size(); pos += frameSize) {
+        auto size = std::min(frameSize, data.size() - pos);
+        std::string frame(ZSTD_compressBound(size), '\0');
+        auto written = ZSTD_compress(&frame[0], frame.size(), data.data() + pos, size, 3);
+        if (ZSTD_isError(written)) {
+            return Err(std::string("Unable to compress tar: ") + ZSTD_getErrorName(written));
+        }
+        compressed.append(frame.data(), written);
+    }
+    return Ok(compressed);
+}
+#endif
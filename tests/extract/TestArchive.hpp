@@ -0,0 +1,46 @@
+#pragma once
+
+#include "legacy/filesystem.hpp"
+#include "include/Result.hpp"
+#include <string>
+#include <vector>
+
+struct TestArchiveEntry {
+    /**
+     * "/"-separated, ending in "/" for 
+     * directories
+     */
+    std::string m_name;
+    std::string m_data;
+    bool m_stored = false;
+};
+
+/**
+ * Data that deflates about as well as 
+ * the CLI's binaries do
+ */
+std::string makeTestData(size_t size, unsigned seed);
+
+/**
+ * Write a zip with wx's own writer, so it's 
+ * laid out like the archives wx & zip tools 
+ * produce
+ */
+Result<> writeTestZip(
+    ghc::filesystem::path const& path,
+    std::vector<TestArchiveEntry> const& entries
+);
+
+#ifdef GEODE_HAS_ZSTD
+/**
+ * A .tar.zst like the CLI's Linux releases, 
+ * split into Zstandard frames of frameSize 
+ * bytes of tar each so that decoding has to 
+ * carry on from one frame to the next. 
+ * Whether an entry is stored is ignored
+ */
+Result<std::string> makeTestTarZst(
+    std::vector<TestArchiveEntry> const& entries,
+    size_t frameSize
+);
+#endif
@@ -0,0 +1,64 @@
+#include "Test.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+std::vector<TestCase>& getTestCases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+void report(std::string const& name, double value, std::string const& unit) {
+    std::printf("    %s: %.2f %s\n", name.c_str(), value, unit.c_str());
+}
+
+static ghc::filesystem::path getTestRoot() {
+    static auto root = ghc::filesystem::temp_directory_path() /
+        ("geode-installer-tests-" + std::to_string(
+            std::chrono::steady_clock::now().time_since_epoch().count()
+        ));
+    return root;
+}
+
+ghc::filesystem::path getTestDirectory(std::string const& name) {
+    auto dir = getTestRoot() / name;
+    std::error_code ec;
+    ghc::filesystem::remove_all(dir, ec);
+    ghc::filesystem::create_directories(dir);
+    return dir;
+}
+
+// runs every test case, or only those of 
+// the suites given on the command line
+int main(int argc, char** argv) {
+    size_t run = 0;
+    size_t failed = 0;
+    for (auto& test : getTestCases()) {
+        if (argc > 1) {
+            bool selected = false;
+            for (int i = 1; i < argc; i++) {
+                if (std::strcmp(argv[i], test.m_suite) == 0) {
+                    selected = true;
+                }
+            }
+            if (!selected) continue;
+        }
+        run++;
+        std::printf("%s.%s\n", test.m_suite, test.m_name);
+        std::fflush(stdout);
+        try {
+            test.m_func();
+        } catch(TestFailure& e) {
+            failed++;
+            std::printf("    FAILED %s\n", e.what());
+        } catch(std::exception& e) {
+            failed++;
+            std::printf("    FAILED with exception: %s\n", e.what());
+        }
+    }
+    std::error_code ec;
+    ghc::filesystem::remove_all(getTestRoot(), ec);
+    std::printf("%zu of %zu tests passed\n", run - failed, run);
+    return failed || !run ? 1 : 0;
+}